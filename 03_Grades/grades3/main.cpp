@@ -1,4 +1,4 @@
-#include <algorithm>    // defines std::sort
+#include <algorithm>    // defines std::nth_element and std::max_element
 #include <iomanip>      // defines std::setpecision and other manipulators
 #include <ios>          // defines std::streamsize
 #include <iostream>     // defines std::cin, std::cout, std::endl and std::istream
@@ -7,15 +7,17 @@
 #include <vector>       // defines std::vector
 
 using std::cin;             using std::setprecision;          
-using std::cout;            using std::sort;
+using std::cout;            using std::nth_element;
+using std::max_element;
 using std::domain_error;    using std::streamsize;
 using std::endl;            using std::string; 
 using std::istream;         using std::vector; 
 
 
 // compute the median of a vector<double>
-// note that calling this function copies the entire argument vector (i.e. call by value), thus the sort() function causes no side effects
-double median(vector<double> vec)
+// note that the argument is NOT copied (i.e. call by reference to const): instead, its values are copied into a
+// scratch vector that is kept between calls, so that no new memory is needed each time the function is called.
+double median(const vector<double>& vec)
 {
     // use the name 'vec_sz' as a synonym for vector<double>::size_type, so that it is easier to read and write.
     typedef vector<double>::size_type vec_sz;
@@ -29,22 +31,29 @@ double median(vector<double> vec)
         throw domain_error("median of an empty vector");
     }
 
-    // sort the elements of the vector, from the first to the last, in monotonic increasing order. (i.e. non-decreasing)
-    sort(vec.begin(), vec.end());
+    // the scratch vector (being 'static', it keeps its memory from one call to the next)
+    static vector<double> scratch;
+    scratch.assign(vec.begin(), vec.end());
 
     // Calculate the midpoint (rounded down to nearest integer) of the vector
     vec_sz mid = size/2;
 
+    // rather than sorting every element, only move them far enough that the element in the mid position
+    // is the one that would be there if the vector were sorted, with no larger elements before it.
+    nth_element(scratch.begin(), scratch.begin() + mid, scratch.end());
+
     // calculate the median: 
-    // - if the size is even, then the median is equal to the sum of the element in the mid position and the previous one.
+    // - if the size is even, then the median is equal to the sum of the element in the mid position and the
+    //   previous one (in sorted order), which is the largest of the elements before the mid position.
     // - otherwise (if size is odd), the median is equal to the element in the mid position.
-    return size % 2 == 0 ? (vec[mid] + vec[mid-1]) / 2 : vec[mid];
+    return size % 2 == 0 ? (scratch[mid] + *max_element(scratch.begin(), scratch.begin() + mid)) / 2
+                         : scratch[mid];
 
     // alternatively, we could have written:
     // if (size % 2 == 0)
-    //     return (vec[mid] + vec[mid-1])/2;
+    //     return (scratch[mid] + *max_element(scratch.begin(), scratch.begin() + mid))/2;
     // else
-    //     return  vec[mid];
+    //     return  scratch[mid];
 }
 
 
@@ -79,7 +88,7 @@ double grade(double midterm, double final, double homework)
 
 // compute a student's overall grade from midterm and final exam grades
 // and vector of homework grades.
-// this function does not copy its argument (i.e. it is called by reference), because median does so for us anyway.
+// this function does not copy its argument (i.e. it is called by reference), and neither does median.
 double grade(double midterm, double final, const vector<double>& hw)
 {
     // if the size of the hw vector is zero, then there is no data that can be used to calculate the homework grades.
@@ -1,16 +1,22 @@
 // this program calculates quartiles of a sequence of numbers.
 #include <algorithm> 
+#include <cstdlib>
 #include <iomanip> 
 #include <ios>
 #include <iostream>
+#include <string>
 #include <vector>
 
+#include "quantile_sketch.h"
+
 using std::cin;
 using std::cout;
 using std::endl;
 using std::setprecision;
 using std::sort;
 using std::streamsize;
+using std::string;
+using std::strtod;
 using std::vector;
 
 
@@ -22,8 +28,64 @@ double interpolate(vector<int> integers, int left_index, double factor) {
     return left + (right - left) * factor;
 }
 
-int main()
+// This function does the same as main(), but without keeping the integers: instead each one is added to
+// a quantile sketch (see quantile_sketch.h), which keeps only a few KB however many integers are read.
+// The quartiles are then estimated from the sketch (with the minimum and maximum still exact).
+int approx_quartiles(double error)
 {
+    cout << "Input a set of integers to find the (approximate) quartiles, "
+            "followed by end-of-file: ";
+
+    int x;
+    Quantile_sketch sketch(error);
+
+    // invariant: 'sketch' summarises all the integers read so far.
+    while(cin >> x) {
+        sketch.insert(x);
+    }
+
+    if (sketch.empty()) {
+        cout << endl << "You must enter a sequence of integers. "
+                        "Please try again." << endl;
+        return 1;
+    }
+
+    streamsize prec = cout.precision();
+    cout << endl << setprecision(4) 
+         << "Minimum: " << sketch.minimum() << endl 
+         << "Lower Quartile: " << sketch.quantile(0.25) << endl
+         << "Median: " << sketch.median() << endl
+         << "Upper Quartile: " << sketch.quantile(0.75) << endl
+         << "Maximum: " << sketch.maximum()
+         << setprecision(prec) << endl;
+
+    return 0;
+}
+
+// Reads the whole of an argument as the error of a quantile sketch, which must be a number strictly
+// between 0 and 1. Returns false (leaving 'e' unchanged) if it is not one.
+bool parse_error(const char* s, double& e) {
+    char* end;
+    double x = strtod(s, &end);
+    if (end == s || *end != '\0' || !(x > 0 && x < 1))
+        return false;
+    e = x;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    // run with "--approx [error]" to estimate the quartiles of a stream too large to keep in memory.
+    if (argc > 1 && string(argv[1]) == "--approx") {
+        double error = 0.01;
+        if (argc > 2 && !parse_error(argv[2], error)) {
+            cout << "Invalid error for '--approx' ('" << argv[2] << "')." << endl;
+            cout << "Usage: main [--approx [error]]   (with 0 < error < 1)" << endl;
+            return 1;
+        }
+        return approx_quartiles(error);
+    }
+
     // Prompt user to input a set of integers.
     cout << "Input a set of integers to find the quartiles, "
             "followed by end-of-file: "; // On macOS: new line, then ctrl-d;
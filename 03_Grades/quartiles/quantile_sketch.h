@@ -0,0 +1,71 @@
+// Guard the header file from multiple inclusions, to prevent an error.
+#ifndef GUARD_quantile_sketch_h
+#define GUARD_quantile_sketch_h
+
+// quantile_sketch.h
+#include <vector>
+
+/**
+ * ========================
+ * A QUANTILE SKETCH (KLL)
+ * ========================
+ * Finding the exact median (or any other quantile) of a sequence means keeping every value of it.
+ * A sketch instead keeps a small *summary* of the values seen so far, from which any quantile can
+ * be estimated to within a chosen error, however many values are added.
+ *
+ * This is a KLL sketch (Karnin, Lang and Liberty, 2016). Values are kept in a stack of "levels",
+ * where each value kept at level h stands in for 2^h of the values added:
+ *  - new values go into level 0.
+ *  - once a level is full, it is sorted and every other value of it is moved up a level (now
+ *    standing in for twice as many values), and the rest are dropped. This is a "compaction".
+ *  - the lower levels hold fewer values than the higher ones (2/3 as many as the level above),
+ *    so the total number of values kept stays roughly 3k, for a given size k.
+ *
+ * The error is given as a fraction of the number of values: with an error of 0.01, the value
+ * returned for the median will be somewhere between the 49% and 51% values (almost always).
+ * An error of 0.01 keeps around 500 doubles, i.e. about 4KB.
+ *
+ * Two sketches (e.g. from different parts of the input, read by different threads) can be
+ * merged into one, which is then a sketch of all the values added to either of them.
+ **/
+class Quantile_sketch {
+public:
+    typedef std::vector<double>::size_type size_type;
+
+    explicit Quantile_sketch(double error = 0.01);
+
+    // add a value to the sketch.
+    void insert(double);
+
+    // add every value of another sketch (made with the same error) to this one.
+    void merge(const Quantile_sketch&);
+
+    /**
+     * Estimates the value that a fraction q (from 0 to 1) of the values added are no greater than,
+     * e.g. q = 0.5 for the median or q = 0.25 for the lower quartile.
+     * The minimum and maximum (q = 0 and q = 1) are always exact.
+     **/
+    double quantile(double q) const;
+    double median() const { return quantile(0.5); }
+
+    double minimum() const { return lo; }
+    double maximum() const { return hi; }
+
+    // the number of values that have been added, and the number actually being kept.
+    unsigned long long count() const { return n; }
+    size_type retained() const;
+    bool empty() const { return n == 0; }
+
+private:
+    std::vector<std::vector<double> > levels;
+    std::vector<bool> odd;      // for each level, whether to keep the odd or even values at its next compaction
+    size_type k;                // the size of the top level
+    unsigned long long n;       // the number of values added
+    double lo, hi;              // the smallest and largest values added
+
+    size_type capacity(size_type) const;
+    void compress();
+    void compact(size_type);
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 
+#include "profile.h"
 #include "split.h"
 
 using std::cin;
@@ -74,8 +75,16 @@ string::size_type width(const vector<string>& v)
 }
 
 
-int main()
+/**
+ * Options:
+ *  --profile  time the stages of the run, writing a summary to "profile.json" and a trace
+ *             to "profile.trace.json" (see profile.h).
+ **/
+int main(int argc, char** argv)
 {
+    // (the profile is written when this goes out of scope, as main() returns)
+    Profile_session profile_session(argc > 1 && string(argv[1]) == "--profile", "profile.json", "profile.trace.json");
+
     // will temporarily hold a phrase as it is inputted.
     string x;
     
@@ -91,34 +100,46 @@ int main()
     cout << "Enter a set of phrases to form a concordance: " << endl;
 
     // read each line of input and store it in a vector (until EOF recieved)
-    while (getline(cin, x)) {
-        phrases.push_back(x);
+    {
+        Profile_scope timer("read_phrases");
+        while (getline(cin, x)) {
+            phrases.push_back(x);
+        }
+        profile_count("phrases", phrases.size());
     }
 
     // iterate over each phrase received
-    for(vector<string>::const_iterator it = phrases.begin(); it != phrases.end(); ++it) {
-        
-        // split the phrase into its words
-        vector<string> words = split(*it);
-
-        // record the maximum width of the word for the sake of padding when we start outputting results
-        maxlen = max(maxlen, width(words));
-
-        // create a Rotation data structure for each word and add it to the full collection.
-        for(vector<string>::size_type j = 0 ; j != words.size(); ++j){
-            Rotation r;
-            r.words = words;
-            r.pivot = j;
-            rotations.push_back(r);
+    {
+        Profile_scope timer("rotate_phrases");
+        for(vector<string>::const_iterator it = phrases.begin(); it != phrases.end(); ++it) {
+            
+            // split the phrase into its words
+            vector<string> words = split(*it);
+
+            // record the maximum width of the word for the sake of padding when we start outputting results
+            maxlen = max(maxlen, width(words));
+
+            // create a Rotation data structure for each word and add it to the full collection.
+            for(vector<string>::size_type j = 0 ; j != words.size(); ++j){
+                Rotation r;
+                r.words = words;
+                r.pivot = j;
+                rotations.push_back(r);
+            }
         }
+        profile_count("rotations", rotations.size());
     }
 
     // sort the rotations according to the alphabetical order of their associated words.
-    sort(rotations.begin(), rotations.end(), compare);
+    {
+        Profile_scope timer("sort_rotations");
+        sort(rotations.begin(), rotations.end(), compare);
+    }
 
     cout << endl;
 
     // output a concordance out of the inputted phrases
+    Profile_scope timer("write_concordance");
     for(vector<Rotation>::const_iterator iter = rotations.begin(); iter != rotations.end(); ++iter) {
 
         // "iter -> words" is equivalent to writting "(*iter).words".
@@ -0,0 +1,332 @@
+#include <algorithm>    // std::min, std::remove_copy_if, std::remove_if, std::stable_partition
+#include <chrono>       // std::chrono::steady_clock
+#include <cstddef>      // std::max_align_t, std::size_t
+#include <cstdint>      // std::uintptr_t
+#include <cstdio>       // std::printf
+#include <cstdlib>      // std::atof, std::atoi, std::malloc, std::free
+#include <ctime>        // std::clock, std::clock_t, CLOCKS_PER_SEC
+#include <iostream>     // std::cout, std::endl
+#include <iterator>     // std::back_inserter
+#include <list>         // std::list
+#include <new>          // std::bad_alloc
+#include <string>       // std::string
+#include <vector>       // std::vector
+
+#include "grade.h"
+#include "Student_info.h"
+
+using std::atof;                using std::list;
+using std::atoi;                using std::min;
+using std::back_inserter;       using std::printf;
+using std::clock;               using std::remove_copy_if;
+using std::clock_t;             using std::remove_if;
+using std::cout;                using std::stable_partition;
+using std::endl;                using std::string;
+using std::free;                using std::vector;
+using std::malloc;
+
+
+/**
+ * ===========
+ * BENCHMARK
+ * ===========
+ * 1) Times extract_fails() (which checks a Grade_result for students who cannot be graded) against
+ *    extract_fails_throwing() (which throws and catches a domain_error for each of them), on lists of
+ *    randomly made students where 0%, 10% and 50% of the students have no homework at all.
+ *
+ * 2) Times EVERY version of extract_fails() there is (those of grade.cpp, the two of Chapter 6's
+ *    "passing" program, and the stable_partition() of Chapter 10's "records3"), on rosters of 1000 up to
+ *    the largest size asked for (10 times larger each time), of which 10%, 50% and 90% of the students
+ *    fail. For each, it gives the time per student, the number of memory allocations, and the most memory
+ *    allocated at once on top of the roster itself (the "peak").
+ *
+ *    The versions that erase failing students from the middle of a vector (v2 and v3) take time
+ *    proportional to the SQUARE of the number of students, so they are only run on the smaller rosters.
+ *
+ * Usage: bench [largest roster (1e6 by default)] [number of runs (5 by default)]
+ **/
+
+// ================ Counting allocations ================
+
+/**
+ * "new" and "delete" are replaced for the whole benchmark, to count every allocation, and the bytes
+ * allocated at the moment (each block starting with a header holding its size, padded out so that
+ * what follows it is as aligned as new must give).
+ **/
+static long long alloc_count = 0, live_bytes = 0, peak_bytes = 0;
+
+union Block_header {
+    std::size_t size;
+    std::max_align_t align;
+};
+
+void* operator new(std::size_t n)
+{
+    Block_header* h = static_cast<Block_header*>(malloc(sizeof(Block_header) + n));
+    if (!h)
+        throw std::bad_alloc();
+    h->size = n;
+    ++alloc_count;
+    live_bytes += n;
+    if (live_bytes > peak_bytes)
+        peak_bytes = live_bytes;
+    return h + 1;
+}
+
+void operator delete(void* p) noexcept
+{
+    if (p) {
+        // (the header is found from the address as a number: the compiler would take "p - 1" to be outside
+        //  the object being deleted, which it is, and warn about it once this is inlined)
+        Block_header* h = reinterpret_cast<Block_header*>(reinterpret_cast<std::uintptr_t>(p) - sizeof(Block_header));
+        live_bytes -= h->size;
+        free(h);
+    }
+}
+
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+
+// ================ Part 1: exceptions against Grade_result ================
+
+// a simple (linear congruential) random number generator, so that every run uses the same students.
+static unsigned long seed = 12345;
+static int random_int(int n)
+{
+    seed = seed * 1103515245 + 12345;
+    return int((seed / 65536) % 32768) % n;
+}
+
+// makes a list of students, where 'missing' out of every 100 have no homework.
+static list<Student_info> make_students(list<Student_info>::size_type count, int missing)
+{
+    list<Student_info> students;
+    Student_info s;
+    s.name = "student";
+    for (list<Student_info>::size_type i = 0; i != count; ++i) {
+        s.midterm = random_int(101);
+        s.final = random_int(101);
+        s.homework.clear();
+        if (random_int(100) >= missing) {
+            int hw_count = 1 + random_int(10);
+            for (int j = 0; j != hw_count; ++j)
+                s.homework.push_back(random_int(101));
+        }
+        students.push_back(s);
+    }
+    return students;
+}
+
+// the number of seconds taken by the fastest of 'runs' calls of extract (each on a fresh copy of the students).
+static double time_extract(list<Student_info> extract(list<Student_info>&), const list<Student_info>& students,
+                           int runs, list<Student_info>::size_type& fails)
+{
+    double best = 1e9;
+    for (int run = 0; run != runs; ++run) {
+        list<Student_info> copy = students;
+        clock_t start = clock();
+        fails = extract(copy).size();
+        best = min(best, double(clock() - start) / CLOCKS_PER_SEC);
+    }
+    return best;
+}
+
+static bool bench_exceptions(int runs)
+{
+    const list<Student_info>::size_type count = 200000;
+    const int rates[] = { 0, 10, 50 };
+
+    cout << "=== Exceptions against Grade_result ===" << endl;
+    cout << count << " students, best of " << runs << " runs:" << endl;
+    for (int i = 0; i != 3; ++i) {
+        list<Student_info> students = make_students(count, rates[i]);
+
+        list<Student_info>::size_type fails, throwing_fails;
+        double no_throw = time_extract(extract_fails, students, runs, fails);
+        double throwing = time_extract(extract_fails_throwing, students, runs, throwing_fails);
+
+        if (fails != throwing_fails) {
+            cout << "The two versions of extract_fails() failed different numbers of students!" << endl;
+            return false;
+        }
+
+        cout << rates[i] << "% without homework: "
+             << "try/catch " << throwing << "s, "
+             << "Grade_result " << no_throw << "s ("
+             << throwing / no_throw << "x)" << endl;
+    }
+    return true;
+}
+
+// ================ Part 2: every version of extract_fails() ================
+
+// (as Chapter 6's "passing" program checks a pass)
+static bool pgrade(const Student_info& s)
+{
+    Grade_result result = try_grade(s);
+    return result.ok && result.value >= 60;
+}
+
+// Chapter 6's two-pass version: copy the failing students out, then remove them.
+static vector<Student_info> extract_fails_copy_if(vector<Student_info>& students)
+{
+    vector<Student_info> fail;
+    remove_copy_if(students.begin(), students.end(), back_inserter(fail), pgrade);
+    students.erase(remove_if(students.begin(), students.end(), fgrade), students.end());
+    return fail;
+}
+
+// Chapter 6's single-pass version: stable_partition(), then copy the failing half out.
+static vector<Student_info> extract_fails_partition(vector<Student_info>& students)
+{
+    vector<Student_info>::iterator iter = stable_partition(students.begin(), students.end(), pgrade);
+    vector<Student_info> fail(iter, students.end());
+    students.erase(iter, students.end());
+    return fail;
+}
+
+/**
+ * Each version, as a function that extracts the failing students of a roster (of its own kind of container),
+ * returning how many there were.
+ **/
+static vector<Student_info>::size_type run_v1(vector<Student_info>& s) { return extract_fails1(s).size(); }
+static vector<Student_info>::size_type run_v2(vector<Student_info>& s) { return extract_fails2(s).size(); }
+static vector<Student_info>::size_type run_v3(vector<Student_info>& s) { return extract_fails3(s).size(); }
+static vector<Student_info>::size_type run_v4(list<Student_info>& s) { return extract_fails4(s).size(); }
+static vector<Student_info>::size_type run_list(list<Student_info>& s) { return extract_fails(s).size(); }
+static vector<Student_info>::size_type run_copy_if(vector<Student_info>& s) { return extract_fails_copy_if(s).size(); }
+static vector<Student_info>::size_type run_partition(vector<Student_info>& s) { return extract_fails_partition(s).size(); }
+static vector<Student_info>::size_type run_moving(vector<Student_info>& s) { return extract_fails_moving(s).size(); }
+
+// Chapter 10's "records3": partitions the records in place (failing students first), copying nothing out.
+static vector<Student_info>::size_type run_records3(vector<Student_info>& s)
+{
+    return stable_partition(s.begin(), s.end(), fgrade) - s.begin();
+}
+
+struct Variant {
+    const char* name;
+    vector<Student_info>::size_type (*on_vector)(vector<Student_info>&);
+    vector<Student_info>::size_type (*on_list)(list<Student_info>&);
+    bool quadratic;
+};
+
+static const Variant variants[] = {
+    { "v1: two new vectors",            run_v1,         0,          false },
+    { "v2: vector, erase by index",     run_v2,         0,          true  },
+    { "v3: vector, erase by iterator",  run_v3,         0,          true  },
+    { "v4: list, erase",                0,              run_v4,     false },
+    { "list, Grade_result",             0,              run_list,   false },
+    { "ch6: remove_copy_if + remove_if", run_copy_if,   0,          false },
+    { "ch6: stable_partition + copy",   run_partition,  0,          false },
+    { "records3: stable_partition",     run_records3,   0,          false },
+    { "v6: single pass, moving",        run_moving,     0,          false },
+};
+
+// the largest roster the quadratic versions are run on
+static const double quadratic_limit = 1e4;
+
+/**
+ * Makes a roster of 'count' students, of which 'failing' out of every 100 fail, all with homework (so every
+ * version can grade them). A failing student's grades are all below 60, and a passing student's all 60 or more.
+ * The same arguments always give the same roster.
+ **/
+template <class Container>
+static void make_roster(Container& roster, long long count, int failing)
+{
+    seed = 54321;
+    roster.clear();
+    Student_info s;
+    s.name = "student";
+    for (long long i = 0; i != count; ++i) {
+        bool fails = random_int(100) < failing;
+        int lo = fails ? 0 : 60, range = fails ? 60 : 41;
+        s.midterm = lo + random_int(range);
+        s.final = lo + random_int(range);
+        s.homework.resize(1 + random_int(10));
+        for (vector<int>::size_type j = 0; j != s.homework.size(); ++j)
+            s.homework[j] = lo + random_int(range);
+        roster.push_back(s);
+    }
+}
+
+// the results of timing one version
+struct Timing {
+    double ns_per_student;
+    long long allocs, peak;
+    vector<Student_info>::size_type fails;
+};
+
+// times one version on a roster (made afresh for each run, outside the timing), keeping the fastest run.
+template <class Container, class Extract>
+static Timing time_variant(Extract extract, long long count, int failing, int runs)
+{
+    Timing best = { 1e300, 0, 0, 0 };
+    for (int run = 0; run != runs; ++run) {
+        Container roster;
+        make_roster(roster, count, failing);
+
+        // count only what the extraction allocates, and its peak above what was allocated before it
+        long long allocs_before = alloc_count, live_before = live_bytes;
+        peak_bytes = live_bytes;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        vector<Student_info>::size_type fails = extract(roster);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / count;
+        if (ns < best.ns_per_student) {
+            best.ns_per_student = ns;
+            best.allocs = alloc_count - allocs_before;
+            best.peak = peak_bytes - live_before;
+            best.fails = fails;
+        }
+    }
+    return best;
+}
+
+static bool bench_variants(double largest, int runs)
+{
+    const int rates[] = { 10, 50, 90 };
+
+    cout << "\n=== Every version of extract_fails() ===" << endl;
+    for (double size = 1e3; size <= largest * 1.0001; size *= 10) {
+        long long count = (long long) size;
+        // (the larger rosters take long enough to time in one run)
+        int size_runs = count <= 100000 ? runs : 1;
+
+        for (int r = 0; r != 3; ++r) {
+            printf("\n%lld students, %d%% failing (best of %d):\n", count, rates[r], size_runs);
+            printf("  %-32s %12s %12s %12s\n", "version", "ns/student", "allocations", "peak (MB)");
+
+            vector<Student_info>::size_type expected = 0;
+            for (std::size_t v = 0; v != sizeof(variants) / sizeof(*variants); ++v) {
+                if (variants[v].quadratic && size > quadratic_limit) {
+                    printf("  %-32s %12s\n", variants[v].name, "(skipped)");
+                    continue;
+                }
+                Timing t = variants[v].on_vector
+                    ? time_variant<vector<Student_info> >(variants[v].on_vector, count, rates[r], size_runs)
+                    : time_variant<list<Student_info> >(variants[v].on_list, count, rates[r], size_runs);
+                printf("  %-32s %12.1f %12lld %12.2f\n", variants[v].name, t.ns_per_student, t.allocs,
+                       t.peak / 1048576.0);
+
+                if (v == 0)
+                    expected = t.fails;
+                else if (t.fails != expected) {
+                    cout << "The versions of extract_fails() failed different numbers of students!" << endl;
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    double largest = argc > 1 ? atof(argv[1]) : 1e6;
+    int runs = argc > 2 ? atoi(argv[2]) : 5;
+    if (runs < 1)
+        runs = 1;
+
+    return bench_exceptions(runs) && bench_variants(largest, runs) ? 0 : 1;
+}
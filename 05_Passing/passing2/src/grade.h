@@ -3,12 +3,35 @@
 
 // grade.h
 #include <list>
+#include <vector>
 #include "Student_info.h"
 
+/**
+ * The result of trying to calculate a grade: either the grade itself, or the reason it could not be calculated.
+ * Unlike grade(), which throws a domain_error when a student cannot be graded, try_grade() never throws, but
+ * returns a Grade_result that is not ok instead. (Throwing and catching an exception is very slow compared with
+ * checking a flag, so this is the version to use for students who may well have no homework.)
+ **/
+struct Grade_result {
+    bool ok;            // whether the grade could be calculated
+    double value;       // the grade (only if ok)
+    const char* error;  // the reason there is no grade (only if not ok)
+};
+
 std::list<Student_info> extract_fails(std::list<Student_info>&);
+std::list<Student_info> extract_fails_throwing(std::list<Student_info>&);
+std::vector<Student_info> extract_fails_moving(std::vector<Student_info>&);
+
+// (the earlier versions of extract_fails(), kept to compare them with in 'make bench')
+std::vector<Student_info> extract_fails1(std::vector<Student_info>&);
+std::vector<Student_info> extract_fails2(std::vector<Student_info>&);
+std::vector<Student_info> extract_fails3(std::vector<Student_info>&);
+std::list<Student_info> extract_fails4(std::list<Student_info>&);
 bool fgrade(const Student_info&);
 double grade(int, int, double);
 double grade(int, int, const std::list<int>&);
 double grade(const Student_info&);
+Grade_result try_grade(int, int, const std::vector<int>&);
+Grade_result try_grade(const Student_info&);
 
 #endif
\ No newline at end of file
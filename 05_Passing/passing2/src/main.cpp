@@ -28,14 +28,14 @@ void output_grades(const list<Student_info>& students, const string::size_type p
         cout << (*iter).name
              << string(pad_factor + 1 - (*iter).name.size(), ' ');
 
-        // compute and write the grade
-        try {
-            double final_grade = grade(*iter);
+        // compute and write the grade (or why there is none)
+        Grade_result result = try_grade(*iter);
+        if (result.ok) {
             streamsize prec = cout.precision();
-            cout << setprecision(3) << final_grade
+            cout << setprecision(3) << result.value
                  << setprecision(prec);
-        } catch (domain_error e) {
-            cout << e.what();
+        } else {
+            cout << result.error;
         }
         cout << endl;
     }
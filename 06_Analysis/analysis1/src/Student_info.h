@@ -5,15 +5,17 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include "homework_store.h"
 
 struct Student_info {
     std::string name;
     int midterm, final;
-    std::vector<int> homework;
+    Hw_span homework;       // (the grades themselves are kept in a Homework_store, see homework_store.h)
 }; // notice the semicolon - it's required
 
 bool compare(const Student_info&, const Student_info&);
-std::istream& read(std::istream&, Student_info&);
+std::istream& read(std::istream&, Student_info&, Homework_store&);
 std::istream& read_hw(std::istream&, std::vector<int>&);
+std::istream& read_hw(std::istream&, Homework_store&, Hw_span&);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,197 @@
+#include <algorithm>    // std::equal_range, std::find, std::remove_copy, std::sort, std::transform
+#include <cstddef>      // std::size_t
+#include <iterator>     // std::back_inserter
+#include <numeric>      // std::accumulate
+#include <stdexcept>    // std::domain_error
+#include <utility>      // std::pair
+#include <vector>       // std::vector
+
+#include "analysis.h"
+#include "grade.h"
+#include "median.h"
+#include "Student_info.h"
+#include "thread_pool.h"
+
+using std::accumulate;          using std::pair;
+using std::back_inserter;       using std::remove_copy;
+using std::domain_error;        using std::sort;
+using std::equal_range;         using std::transform;
+using std::find;                using std::vector;
+using std::size_t;
+
+
+// The homework is counted as "all done" if the homework is non-empty, and none of its values are zero.
+bool did_all_hw(const Student_info& s)
+{   
+    // (rather than find() going through the grades one at a time, the span scans its grades in the store at once)
+    return !s.homework.empty() && !s.homework.has_zero();
+}
+
+/**
+ * This acts as an auxilirary or extention of the grade() function.
+ * If there is a problem calculating the grade (likely due to no homework grades inputted), 
+ *  it puts down the homework grade used for calculating the final grade as zero.
+ **/
+double grade_aux(const Student_info& s)
+{
+    // (checked through try_grade() rather than by catching the domain_error that grade() would throw)
+    Grade_result result = try_grade(s);
+    return result.ok ? result.value : grade(s.midterm, s.final, 0);
+}
+
+/**
+ * This acts as an auxilirary or extention of the average_grade() function.
+ * (The average of the student's homework grades is used in the final grade calculation rather than the median.)
+ **/
+double average_grade_aux(const Student_info& s)
+{
+    Grade_result result = try_average_grade(s);
+    return result.ok ? result.value : grade(s.midterm, s.final, 0);
+}
+
+/**
+ * This function follows the standard grading scheme (uses median homework grade), but only considers non-zero homework grades
+ * in the calculation.
+ **/
+double optimistic_grade(const Student_info& s)
+{
+    // form a vector that will hold only non-zero homework grades.
+    vector<int> nonzero_hw;
+    
+    // add all values not equal to 0 to the nonzero_hw vector. i.e. extract all values that are non-zero.
+    // (WITHOUT modifying the original homework vector, hence the "copy")
+    remove_copy(s.homework.begin(), s.homework.end(),
+                back_inserter(nonzero_hw), 0);
+    if(nonzero_hw.empty())
+        return grade(s.midterm, s.final, 0);
+    else
+        return grade(s.midterm, s.final, median(nonzero_hw));
+}
+
+/**
+ * The mainline analysis function, taking as input a vector of student records,
+ * and calculates their final grades using a given grading scheme, and returns the median of these grades.
+ **/
+double analysis(const vector<Student_info>& students, double grading_scheme(const Student_info&))
+{
+    vector<double> grades;
+    transform(students.begin(), students.end(),
+              back_inserter(grades), grading_scheme);
+
+    return median(grades);
+}
+
+// ================================ The fused analysis ================================
+
+/**
+ * The value in position k of the sorted homework with its zeros taken out, where the zeros are the
+ * positions [zeros_begin, zeros_end) of the sorted homework. (So no copy of the non-zero grades is needed.)
+ **/
+static int nonzero_at(const vector<int>& sorted, vector<int>::size_type k,
+                      vector<int>::size_type zeros_begin, vector<int>::size_type zeros_end)
+{
+    return k < zeros_begin ? sorted[k] : sorted[k + (zeros_end - zeros_begin)];
+}
+
+void summarise_hw(const Hw_span& hw, vector<int>& scratch, Hw_summary& summary)
+{
+    typedef vector<int>::size_type vec_sz;
+
+    summary.any = !hw.empty();
+    summary.any_nonzero = false;
+    summary.median = summary.average = summary.nonzero_median = 0;
+    if (!summary.any)
+        return;
+
+    // sort a copy of the homework once, for every statistic below.
+    scratch.assign(hw.begin(), hw.end());
+    sort(scratch.begin(), scratch.end());
+
+    vec_sz size = scratch.size(), mid = size / 2;
+
+    // (calculated in exactly the same way as median() and average() do)
+    summary.median = size % 2 == 0 ? (scratch[mid] + scratch[mid-1]) / 2.0 : scratch[mid];
+    summary.average = accumulate(scratch.begin(), scratch.end(), 0) / scratch.size();
+
+    // the zeros are all next to each other in the sorted homework, so the non-zero grades are the ones around them.
+    pair<vector<int>::const_iterator, vector<int>::const_iterator> zeros =
+        equal_range(scratch.begin(), scratch.end(), 0);
+    vec_sz zb = zeros.first - scratch.begin(), ze = zeros.second - scratch.begin();
+    vec_sz nonzero = size - (ze - zb);
+
+    summary.any_nonzero = nonzero != 0;
+    if (summary.any_nonzero) {
+        vec_sz nmid = nonzero / 2;
+        summary.nonzero_median = nonzero % 2 == 0 ?
+            (nonzero_at(scratch, nmid, zb, ze) + nonzero_at(scratch, nmid - 1, zb, ze)) / 2.0 :
+            nonzero_at(scratch, nmid, zb, ze);
+    }
+}
+
+double scheme_grade(const Student_info& s, const Hw_summary& summary, Grading_scheme scheme)
+{
+    // (as in grade_aux() and the others, a student without any homework counts it as zero)
+    switch (scheme) {
+    case standard_scheme:
+        return grade(s.midterm, s.final, summary.any ? summary.median : 0);
+    case average_scheme:
+        return grade(s.midterm, s.final, summary.any ? summary.average : 0);
+    case optimistic_scheme:
+        return grade(s.midterm, s.final, summary.any_nonzero ? summary.nonzero_median : 0);
+    }
+    throw domain_error("unknown grading scheme");
+}
+
+// grades the students in positions [first, last) under every scheme, into grades[scheme][student].
+static void grade_students(const vector<Student_info>& students, const vector<Grading_scheme>& schemes,
+                           vector<vector<double> >& grades, size_t first, size_t last)
+{
+    // each student's homework is sorted just once (into the same scratch vector), for every scheme.
+    vector<int> scratch;
+    Hw_summary summary;
+    for (size_t i = first; i != last; ++i) {
+        summarise_hw(students[i].homework, scratch, summary);
+        for (vector<Grading_scheme>::size_type s = 0; s != schemes.size(); ++s)
+            grades[s][i] = scheme_grade(students[i], summary, schemes[s]);
+    }
+}
+
+vector<double> fused_analysis(const vector<Student_info>& students, const vector<Grading_scheme>& schemes)
+{
+    // (a pool of a single thread runs everything on this one)
+    Thread_pool serial(1);
+    return fused_analysis(students, schemes, serial);
+}
+
+vector<double> fused_analysis(const vector<Student_info>& students, const vector<Grading_scheme>& schemes,
+                              Thread_pool& pool)
+{
+    // the grade of every student under each scheme, each written to its own place by whichever thread grades it.
+    vector<vector<double> > grades(schemes.size(), vector<double>(students.size()));
+    pool.parallel_for(students.size(), 4096, [&](size_t first, size_t last) {
+        grade_students(students, schemes, grades, first, last);
+    });
+
+    // then the median of each scheme's grades, all at once.
+    vector<double> medians(schemes.size());
+    pool.parallel_for(schemes.size(), 1, [&](size_t first, size_t last) {
+        for (size_t s = first; s != last; ++s)
+            medians[s] = median(grades[s]);
+    });
+    return medians;
+}
+
+/**
+ * === ALGORITHMS ===
+ * find(iter1, iter2, value) - searches a container bounded by iterators [iter1, iter2) and returns the iterator pointing to the 
+ *  first occurance of value in the collection. If not found, then iter2 is returned.
+ * -------------------
+ * transform(iter1, iter2, iter_out, f) - used to apply a function f to a collection of values bound by the iterators [iter1, iter2), 
+ *  writting the outputs into another (or the same) collection starting from the position pointed to by iter_out. 
+ * -------------------
+ * back_inserter(c) - prepares an iterator that points to the end of a container c, allowing more values to be appended to it.
+ * -------------------
+ * remove_copy(iter1, iter2, iter_out, val) - traverses over a container bounded by iterators [iter1, iter2) and, without deleting 
+ *  values from the original container (hence the "copy"), extracts all values != val to a new (or the same) container 
+ *  starting from the position pointed to by iter_out.
+ **/
@@ -0,0 +1,60 @@
+#ifndef GUARD_analysis_h
+#define GUARD_analysis_h
+
+// analysis.h
+#include <vector>
+#include "Student_info.h"
+#include "thread_pool.h"
+
+// -- The grading schemes, one student at a time --
+bool did_all_hw(const Student_info&);
+double grade_aux(const Student_info&);
+double average_grade_aux(const Student_info&);
+double optimistic_grade(const Student_info&);
+
+// the median final grade of a group of students under a single grading scheme
+double analysis(const std::vector<Student_info>&, double grading_scheme(const Student_info&));
+
+/**
+ * ======================
+ * THE FUSED ANALYSIS
+ * ======================
+ * Calling analysis() once per grading scheme walks over every student once per scheme, and every scheme
+ * that uses the median sorts (a copy of) the student's homework again.
+ *
+ * The fused analysis instead walks over the students once, working out every homework statistic that
+ * the schemes need from a single sorted copy of each student's homework (see Hw_summary), and then
+ * grades the student under every scheme asked for at once.
+ **/
+
+// the grading schemes that the fused analysis can apply.
+enum Grading_scheme { standard_scheme, average_scheme, optimistic_scheme };
+
+// the homework statistics used by the grading schemes, all worked out from one sorted copy of the homework.
+struct Hw_summary {
+    bool any;               // whether any homework grades were given
+    bool any_nonzero;       // whether any of them were non-zero
+    double median, average, nonzero_median;
+};
+
+// summarises a student's homework, using (and re-using) the given scratch vector to sort a copy of it.
+void summarise_hw(const Hw_span&, std::vector<int>& scratch, Hw_summary&);
+
+// a student's final grade under a grading scheme, from the summary of their homework.
+double scheme_grade(const Student_info&, const Hw_summary&, Grading_scheme);
+
+/**
+ * The median final grade of a group of students under each of the given grading schemes, in the same
+ * order, computed in a single pass over the students. (Each is exactly the same as analysis() gives.)
+ **/
+std::vector<double> fused_analysis(const std::vector<Student_info>&, const std::vector<Grading_scheme>&);
+
+/**
+ * The same, with the students graded in parallel chunks on a thread pool, and the medians of each scheme
+ * taken at the same time. Every grade is stored in the same place as in the serial version, so the
+ * medians are exactly the same.
+ **/
+std::vector<double> fused_analysis(const std::vector<Student_info>&, const std::vector<Grading_scheme>&,
+                                   Thread_pool&);
+
+#endif
@@ -3,6 +3,7 @@
 #include <vector>       // defines std::vector
 
 #include "average.h"
+#include "homework_store.h"
 
 using std::accumulate;
 using std::domain_error;
@@ -38,6 +39,22 @@ double average(const vector<double>& v)
     return accumulate(v.begin(), v.end(), 0.0) / v.size();
 
 }
+// calculates the average of the homework grades [b, e) of a student (in one pass, without copying them)
+double average(Hw_span::const_iterator b, Hw_span::const_iterator e)
+{
+    int sum = 0;
+    vector<int>::size_type size = 0;
+    for (; b != e; ++b, ++size)
+        sum += *b;
+
+    if (size == 0) {
+        throw domain_error("average of an empty vector");
+    }
+
+    // (divided in exactly the same way as average(const vector<int>&) does)
+    return sum / size;
+}
+
 /**
  * === ALGORITHMS ===
  * accumulate(iter1, iter2, init_value) - starting at init_value, the function sums the values of a containter 
@@ -4,7 +4,10 @@
 
 // average.h
 #include <vector>
+#include "homework_store.h"
 double average(const std::vector<double>&);
 double average(const std::vector<int>&);
+// the average of a student's homework grades, read straight from the homework store
+double average(Hw_span::const_iterator, Hw_span::const_iterator);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include <algorithm>    // std::min
+#include <chrono>       // std::chrono::steady_clock, std::chrono::duration
+#include <cstdlib>      // std::atoi
+#include <ctime>        // std::clock, std::clock_t, CLOCKS_PER_SEC
+#include <iostream>     // std::cout, std::endl
+#include <vector>       // std::vector
+
+#include "analysis.h"
+#include "Student_info.h"
+#include "thread_pool.h"
+
+using std::chrono::duration;    using std::chrono::steady_clock;
+using std::atoi;                using std::endl;
+using std::clock;               using std::min;
+using std::clock_t;             using std::vector;
+using std::cout;
+
+
+/**
+ * ===========
+ * BENCHMARK
+ * ===========
+ * Times the three-pass analysis (analysis() called once per grading scheme, for each group) against the
+ * fused analysis (fused_analysis() called once for each group), over the same randomly made students,
+ * and checks that both give exactly the same medians. The fused analysis is also timed on a thread pool.
+ *
+ * Usage: bench [number of students] [number of runs]
+ **/
+
+// a simple (linear congruential) random number generator, so that every run uses the same students.
+static unsigned long seed = 12345;
+static int random_int(int n)
+{
+    seed = seed * 1103515245 + 12345;
+    return int((seed / 65536) % 32768) % n;
+}
+
+static void make_students(vector<Student_info>::size_type count, Homework_store& store,
+                          vector<Student_info>& did, vector<Student_info>& didnt)
+{
+    Student_info s;
+    for (vector<Student_info>::size_type i = 0; i != count; ++i) {
+        s.midterm = random_int(101);
+        s.final = random_int(101);
+
+        // between 0 and 15 homework grades, with about 1 in 20 of them missed (zero)
+        Homework_store::size_type first = store.size();
+        int hw_count = random_int(16);
+        for (int j = 0; j != hw_count; ++j)
+            store.push_back(random_int(20) == 0 ? 0 : 40 + random_int(61));
+        s.homework = store.since(first);
+
+        if (did_all_hw(s))
+            did.push_back(s);
+        else
+            didnt.push_back(s);
+    }
+}
+
+// the number of seconds since the given clock reading
+static double seconds_since(clock_t start)
+{
+    return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char** argv)
+{
+    vector<Student_info>::size_type count = argc > 1 ? atoi(argv[1]) : 200000;
+    int runs = argc > 2 ? atoi(argv[2]) : 5;
+
+    Homework_store store;
+    vector<Student_info> did, didnt;
+    make_students(count, store, did, didnt);
+
+    double (* const schemes[])(const Student_info&) = { grade_aux, average_grade_aux, optimistic_grade };
+    const Grading_scheme ids[] = { standard_scheme, average_scheme, optimistic_scheme };
+    const vector<Grading_scheme> id_list(ids, ids + 3);
+
+    // (the best of several runs is taken, being the least disturbed by anything else running)
+    Thread_pool pool;
+    double three_pass = 1e9, fused = 1e9, parallel = 1e9;
+    vector<double> expected(6), got;
+    for (int run = 0; run != runs; ++run) {
+        clock_t start = clock();
+        for (int i = 0; i != 3; ++i) {
+            expected[i] = analysis(did, schemes[i]);
+            expected[i + 3] = analysis(didnt, schemes[i]);
+        }
+        three_pass = min(three_pass, seconds_since(start));
+
+        start = clock();
+        got = fused_analysis(did, id_list);
+        vector<double> didnt_medians = fused_analysis(didnt, id_list);
+        got.insert(got.end(), didnt_medians.begin(), didnt_medians.end());
+        fused = min(fused, seconds_since(start));
+
+        if (got != expected) {
+            cout << "The fused analysis gave different medians from the three-pass analysis!" << endl;
+            return 1;
+        }
+
+        // (the wall-clock time is what matters here, as clock() adds up the time of every thread)
+        steady_clock::time_point wall = steady_clock::now();
+        got = fused_analysis(did, id_list, pool);
+        didnt_medians = fused_analysis(didnt, id_list, pool);
+        got.insert(got.end(), didnt_medians.begin(), didnt_medians.end());
+        parallel = min(parallel, duration<double>(steady_clock::now() - wall).count());
+
+        if (got != expected) {
+            cout << "The parallel analysis gave different medians from the serial analysis!" << endl;
+            return 1;
+        }
+    }
+
+    cout << count << " students (" << did.size() << " did all homework), best of " << runs << " runs:" << endl
+         << "Three-pass analysis: " << three_pass << "s" << endl
+         << "Fused analysis:      " << fused << "s" << endl
+         << "Speed-up:            " << three_pass / fused << "x" << endl
+         << "Fused analysis on " << pool.size() << " threads: " << parallel << "s ("
+         << three_pass / parallel << "x)" << endl;
+    return 0;
+}
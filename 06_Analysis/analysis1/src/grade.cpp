@@ -16,36 +16,92 @@ double grade(int midterm, int final, double homework)
     return 0.2 * midterm + 0.4 * final + 0.4 * homework;
 }
 
+// the result of a grade that could be calculated, and of one that could not.
+static Grade_result graded(double value)
+{
+    Grade_result result;
+    result.ok = true;
+    result.value = value;
+    result.error = 0;
+    return result;
+}
+
+static Grade_result no_homework()
+{
+    Grade_result result;
+    result.ok = false;
+    result.value = 0;
+    result.error = "student has done no homework";
+    return result;
+}
+
+// the value of a Grade_result, or (for the throwing versions of the functions) a domain_error if there is none.
+static double value_or_throw(const Grade_result& result)
+{
+    if (!result.ok)
+        throw domain_error(result.error);
+    return result.value;
+}
+
+// try to compute a student's overall grade from midterm and final exam grades and vector of homework grades,
+// without throwing an exception if it cannot be done.
+Grade_result try_grade(int midterm, int final, const vector<int>& hw)
+{
+    // if the size of the hw vector is zero, then there is no data that can be used to calculate the homework grades.
+    if (hw.size() == 0)
+        return no_homework();
+
+    return graded(grade(midterm, final, median(hw)));
+}
+
+// (the same, for a student's record: the homework grades are read straight from the homework store)
+Grade_result try_grade(const Student_info& s)
+{
+    if (s.homework.empty())
+        return no_homework();
+
+    return graded(grade(s.midterm, s.final, median(s.homework.begin(), s.homework.end())));
+}
+
 // compute a student's overall grade from midterm and final exam grades and vector of homework grades.
 double grade(int midterm, int final, const vector<int>& hw)
 {
-    // if the size of the hw vector is zero, then there is no data that can be used to calculate the homework grades.
-    if (hw.size()== 0)
-        throw domain_error("student has done no homework");
-    
-    return grade(midterm, final, median(hw));
+    return value_or_throw(try_grade(midterm, final, hw));
 
 }
 
 double grade(const Student_info& s)
 {
-    return grade(s.midterm, s.final, s.homework);
+    return value_or_throw(try_grade(s));
 }
 
 // compute a student's final grade, using the aveage value of the homework grades rather than the median.
 double average_grade(int midterm, int final, const vector<int>& hw)
+{
+    return value_or_throw(try_average_grade(midterm, final, hw));
+}
+
+// (the same, without throwing an exception if it cannot be done)
+Grade_result try_average_grade(int midterm, int final, const vector<int>& hw)
 {
     // if the size of the hw vector is zero, then there is no data that can be used to calculate the homework grades.
-    if (hw.size()== 0)
-        throw domain_error("student has done no homework");
-    
-    return grade(midterm, final, average(hw));
+    if (hw.size() == 0)
+        return no_homework();
+
+    return graded(grade(midterm, final, average(hw)));
+}
+
+Grade_result try_average_grade(const Student_info& s)
+{
+    if (s.homework.empty())
+        return no_homework();
 
+    return graded(grade(s.midterm, s.final, average(s.homework.begin(), s.homework.end())));
 }
 
 double average_grade(const Student_info& s)
 {
-    return average_grade(s.midterm, s.final, s.homework); 
+    return value_or_throw(try_average_grade(s));
 }
 
 // predicate to determine whether a student failed
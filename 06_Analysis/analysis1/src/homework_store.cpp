@@ -0,0 +1,46 @@
+#include <cstddef>      // std::size_t
+#include <cstring>      // std::memchr
+#include <vector>       // std::vector
+
+#include "homework_store.h"
+
+using std::memchr;              using std::vector;
+using std::size_t;
+
+
+void Homework_store::push_back(int x)
+{
+    if (narrow && (x < 0 || x > 255)) {
+        // the first grade that does not fit in a byte: move every grade kept so far into the ints, once.
+        ints.assign(bytes.begin(), bytes.end());
+        vector<unsigned char>().swap(bytes);
+        narrow = false;
+    }
+
+    if (narrow)
+        bytes.push_back((unsigned char) x);
+    else
+        ints.push_back(x);
+}
+
+bool Homework_store::has_zero(size_type first, size_type n) const
+{
+    if (n == 0)
+        return false;
+    if (narrow)
+        return memchr(&bytes[first], 0, n) != 0;
+
+    // (a loop without an early exit, which the compiler is free to vectorise)
+    const int* p = &ints[first];
+    bool zero = false;
+    for (size_type i = 0; i != n; ++i)
+        zero |= p[i] == 0;
+    return zero;
+}
+
+void Homework_store::clear()
+{
+    bytes.clear();
+    ints.clear();
+    narrow = true;
+}
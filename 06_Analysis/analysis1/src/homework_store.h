@@ -0,0 +1,114 @@
+// Guard the header file from multiple inclusions, to prevent an error.
+#ifndef GUARD_homework_store_h
+#define GUARD_homework_store_h
+
+// homework_store.h
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+/**
+ * ==================
+ * THE HOMEWORK STORE
+ * ==================
+ * Giving every student a vector<int> of their own means a separate block of memory (plus the vector
+ * itself, 24 bytes) for each student's homework, scattered all over memory.
+ *
+ * A Homework_store instead keeps the homework grades of every student of a dataset in ONE array,
+ * each student's grades straight after the last student's, so each student only needs to know where
+ * their grades start and how many there are (an Hw_span). This is the "compressed sparse row" layout:
+ *
+ *      grades:   [ 85 92 70 | 60 0 75 88 | | 95 ... ]
+ *      spans:    (0, 3)     (3, 4)         (7, 0) (7, ...)
+ *
+ * While every grade fits in a byte (0 to 255, as almost all grades do), they are kept as bytes, a
+ * quarter of the size of an int. The first grade that does not fit moves every grade into an array
+ * of ints instead (once), after which all grades are kept as ints.
+ *
+ * Scans over the grades (such as looking for a zero) then run along contiguous memory, and over bytes
+ * use std::memchr, which the standard library implements with vector instructions.
+ **/
+
+class Homework_store;
+
+// one student's homework: a range of the grades in a Homework_store
+class Hw_span {
+public:
+    typedef std::size_t size_type;
+
+    // (reads each grade from the store, as an int, whichever way it is kept)
+    class const_iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const int* pointer;
+        typedef int reference;
+
+        const_iterator(): store(0), i(0) { }
+        const_iterator(const Homework_store* s, size_type n): store(s), i(n) { }
+        int operator*() const;
+        const_iterator& operator++() { ++i; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++i; return old; }
+        bool operator==(const const_iterator& o) const { return i == o.i; }
+        bool operator!=(const const_iterator& o) const { return i != o.i; }
+
+    private:
+        const Homework_store* store;
+        size_type i;
+    };
+
+    Hw_span(): store(0), first(0), count(0) { }
+    Hw_span(const Homework_store& s, size_type f, size_type n): store(&s), first(f), count(n) { }
+
+    size_type size() const { return count; }
+    bool empty() const { return count == 0; }
+    int operator[](size_type i) const;
+
+    const_iterator begin() const { return const_iterator(store, first); }
+    const_iterator end() const { return const_iterator(store, first + count); }
+
+    // whether any of the grades is zero (in a single scan along the store)
+    bool has_zero() const;
+
+private:
+    const Homework_store* store;
+    size_type first, count;
+};
+
+class Homework_store {
+public:
+    typedef std::size_t size_type;
+
+    Homework_store(): narrow(true) { }
+
+    // the total number of grades kept
+    size_type size() const { return narrow ? bytes.size() : ints.size(); }
+    // whether the grades are kept as bytes
+    bool is_narrow() const { return narrow; }
+
+    // the grade at a position
+    int operator[](size_type i) const { return narrow ? bytes[i] : ints[i]; }
+
+    // adds a grade to the end of the store
+    void push_back(int);
+    // the span of every grade from the given position to the end (i.e. those added since it was the size)
+    Hw_span since(size_type first) const { return Hw_span(*this, first, size() - first); }
+
+    // whether any of the n grades from position first is zero
+    bool has_zero(size_type first, size_type n) const;
+
+    // removes every grade (which makes every span of the store invalid)
+    void clear();
+
+private:
+    bool narrow;
+    std::vector<unsigned char> bytes;   // the grades, while they all fit in a byte
+    std::vector<int> ints;              // the grades, once one of them does not
+};
+
+inline int Hw_span::const_iterator::operator*() const { return (*store)[i]; }
+inline int Hw_span::operator[](size_type i) const { return (*store)[first + i]; }
+inline bool Hw_span::has_zero() const { return count != 0 && store->has_zero(first, count); }
+
+#endif
@@ -1,101 +1,170 @@
-#include <algorithm>    // std::find, std::remove_copy, std::transform
+#include <cstddef>      // std::size_t
+#include <cstdlib>      // std::strtod, std::strtol
 #include <iostream>     // std::cin, std::cout, std::endl
-#include <iterator>     // std::back_inserter
-#include <stdexcept>    // std::domain_error
 #include <string>       // std::string
+#include <thread>       // std::thread
 #include <vector>       // std::vector
 
-#include "grade.h"
-#include "median.h"
+#include "analysis.h"
+#include "quantile_sketch.h"
 #include "Student_info.h"
+#include "thread_pool.h"
 
-using std::back_inserter;       using std::find;
-using std::cin;                 using std::remove_copy;
+using std::cin;                 using std::size_t;
 using std::cout;                using std::string;
-using std::domain_error;        using std::transform;
-using std::endl;                using std::vector;
+using std::endl;                using std::strtod;
+using std::strtol;              using std::thread;
+using std::vector;
 
 
-// The homework is counted as "all done" if the homework vector is non-empty, and none of its values are zero.
-bool did_all_hw(const Student_info& s)
-{   
-    // If the find() algorithm fails to find a value equal to 0, and at least one grade exists, then all homework is done.
-    return ((find(s.homework.begin(), s.homework.end(), 0)) == s.homework.end()) && (!s.homework.empty()) ;
-}
+/**
+ * The grading schemes compared, with each of their titles:
+ *  1) standard grading scheme - incorporates the median of homework grades in the calculation
+ *  2) average homework grading scheme - incorporates the average of homework grades in the calculation
+ *  3) "optimistic" homework grading scheme - uses standard grading scheme, but ignores homework not done.
+ **/
+const int scheme_count = 3;
+const string scheme_titles[scheme_count] = {
+    "Standard grading scheme", "Average homework grading scheme", "Turned-in homework grading scheme"
+};
+const Grading_scheme scheme_ids[scheme_count] = {
+    standard_scheme, average_scheme, optimistic_scheme
+};
 
 /**
- * This acts as an auxilirary or extention of the grade() function.
- * If there is a problem calculating the grade (likely due to no homework grades inputted), 
- *  it puts down the homework grade used for calculating the final grade as zero.
+ * This procedure is used to output the results of an analysis comparing the final grades of students who did all 
+ * their homework with students who have not, under a given grading scheme
  **/
-double grade_aux(const Student_info& s)
+void write_analysis(const string title, double did_hw_median, double didnt_hw_median)
 {
-    try {
-        return grade(s);
-    } catch (domain_error) {
-        return grade(s.midterm, s.final, 0);
-    }
+    cout << "\n(" << title << ") - median final grade of students who:" << endl;
+    cout << "Did all homework:       " << did_hw_median << endl;
+    cout << "Didn't do all homework: " << didnt_hw_median << endl;
 }
 
 /**
- * This acts as an auxilirary or extention of the average_grade() function.
- * (The average of the student's homework grades is used in the final grade calculation rather than the median.)
+ * =================
+ * APPROXIMATE MODE
+ * =================
+ * The analyses keep every student record (and every final grade) in memory, just to take medians.
+ * In the approximate mode, each record is instead graded under every scheme as soon as it is read, and the
+ * grade added to a quantile sketch (see quantile_sketch.h) for its group, after which the record is thrown away.
+ * So however many records are read, only the six sketches (a few KB each) are kept.
+ *
+ * Since sketches can be merged, the median over all students is also given, from the two groups' sketches.
  **/
-double average_grade_aux(const Student_info& s)
+
+// the same as write_analysis(), but with the medians estimated from the sketches of each group.
+void write_approx_analysis(const string title, const Quantile_sketch& did_hw, const Quantile_sketch& didnt_hw)
 {
-    try {
-        return average_grade(s);
-    } catch (domain_error) {
-        return grade(s.midterm, s.final, 0);
-    }
+    Quantile_sketch all = did_hw;
+    all.merge(didnt_hw);
+
+    cout << "\n(" << title << ") - median final grade of students who:" << endl;
+    cout << "Did all homework:       " << did_hw.median() << endl;
+    cout << "Didn't do all homework: " << didnt_hw.median() << endl;
+    cout << "(All students:          " << all.median() << ")" << endl;
 }
 
-/**
- * This function follows the standard grading scheme (uses median homework grade), but only considers non-zero homework grades
- * in the calculation.
- **/
-double optimistic_grade(const Student_info& s)
+int approx_main(double error)
 {
-    // form a vector that will hold only non-zero homework grades.
-    vector<int> nonzero_hw;
-    
-    // add all values not equal to 0 to the nonzero_hw vector. i.e. extract all values that are non-zero.
-    // (WITHOUT modifying the original homework vector, hence the "copy")
-    remove_copy(s.homework.begin(), s.homework.end(),
-                back_inserter(nonzero_hw), 0);
-    if(nonzero_hw.empty())
-        return grade(s.midterm, s.final, 0);
-    else
-        return grade(s.midterm, s.final, median(nonzero_hw));
+    // a sketch of the final grades of each group, under each grading scheme
+    vector<Quantile_sketch> did(scheme_count, Quantile_sketch(error)),
+                            didnt(scheme_count, Quantile_sketch(error));
+    Student_info student;
+    // (only the homework of the record being graded is kept, so the store is emptied before each one)
+    Homework_store store;
+
+    cout << "This program compares the final grades of those who did all their homework with those who have not.\n"
+         << "Please enter the records of each student (name, midterm and final exam grades, homework grades), "
+            "followed by end-of-file:" 
+         << endl;
+
+    // grade each record under every scheme as it is read, adding the grades to the sketches of its group.
+    vector<int> scratch;
+    Hw_summary summary;
+    while ((store.clear(), read(cin, student, store))) {
+        vector<Quantile_sketch>& group = did_all_hw(student) ? did : didnt;
+        summarise_hw(student.homework, scratch, summary);
+        for (int i = 0; i != scheme_count; ++i)
+            group[i].insert(scheme_grade(student, summary, scheme_ids[i]));
+    }
+
+    if (did[0].empty()) {
+        cout << "No student did all the homework!" << endl;
+        return 1;
+    }
+    if (didnt[0].empty()) {
+        cout << "Every student did all the homework!" << endl;
+        return 1;
+    }
+
+    cout << "\nComparing the final grades between students who did all homework and those who didn\'t "
+            "(approximately, to within " << error * 100 << "% of the students): " << endl;
+
+    for (int i = 0; i != scheme_count; ++i)
+        write_approx_analysis(scheme_titles[i], did[i], didnt[i]);
+
+    return 0;
 }
 
 /**
- * The mainline analysis function, taking as input a vector of student records,
- * and calculates their final grades using a given grading scheme, and returns the median of these grades.
+ * Reads the whole of an argument as the error of a quantile sketch, which must be a number
+ * strictly between 0 and 1. Returns false (leaving e unchanged) if it is not one.
  **/
-double analysis(const vector<Student_info>& students, double grading_scheme(const Student_info&))
+bool parse_error(const char* s, double& e)
 {
-    vector<double> grades;
-    transform(students.begin(), students.end(),
-              back_inserter(grades), grading_scheme);
-
-    return median(grades);
+    char* end;
+    double x = strtod(s, &end);
+    if (end == s || *end != '\0' || !(x > 0 && x < 1))
+        return false;
+    e = x;
+    return true;
 }
+
+// the most threads that may be asked for with "--jobs"
+const long max_jobs = 256;
+
 /**
- * This procedure is used to output the results of an analysis comparing the final grades of students who did all 
- * their homework with students who have not, under a given grading scheme
+ * Reads the whole of an argument as a number of threads, from 1 to max_jobs. Returns false
+ * (leaving n unchanged) if it is not one.
  **/
-void write_analysis(const string title, double grading_scheme(const Student_info&),
-                    const vector<Student_info>& did_hw, const vector<Student_info>& didnt_hw)
+bool parse_jobs(const char* s, unsigned& n)
 {
-    cout << "\n(" << title << ") - median final grade of students who:" << endl;
-    cout << "Did all homework:       " << analysis(did_hw, grading_scheme) << endl;
-    cout << "Didn't do all homework: " << analysis(didnt_hw, grading_scheme) << endl;
+    char* end;
+    long x = strtol(s, &end, 10);
+    if (end == s || *end != '\0' || x < 1 || x > max_jobs)
+        return false;
+    n = unsigned(x);
+    return true;
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    static const char usage[] = "Usage: main [--approx [error]] | [--jobs N]   (with 0 < error < 1, and 1 <= N <= 256)";
+
+    // "--approx [error]" estimates the medians using quantile sketches, rather than keeping every record.
+    if (argc > 1 && string(argv[1]) == "--approx") {
+        double error = 0.01;
+        if (argc > 2 && !parse_error(argv[2], error)) {
+            cout << "Invalid error for '--approx' ('" << argv[2] << "')." << endl;
+            cout << usage << endl;
+            return 1;
+        }
+        return approx_main(error);
+    }
+
+    // "--jobs N" sets the number of threads to analyse with (by default, one for each processor core).
+    unsigned jobs = thread::hardware_concurrency();
+    if (argc > 2 && string(argv[1]) == "--jobs" && !parse_jobs(argv[2], jobs)) {
+        cout << "Invalid number of threads for '--jobs' ('" << argv[2] << "')." << endl;
+        cout << usage << endl;
+        return 1;
+    }
+
     // students who did and didn't do all their homework
+    // (with all their homework kept in a single store, see homework_store.h)
+    Homework_store store;
     vector<Student_info> did, didnt;
     Student_info student;
 
@@ -106,7 +175,7 @@ int main()
          << endl;
 
     // read all the records, separating them based on whether all homework was done
-    while (read(cin, student)) {
+    while (read(cin, student, store)) {
         if (did_all_hw(student))
             did.push_back(student);
         else
@@ -126,28 +195,20 @@ int main()
     // do the analyses
     cout << "\nComparing the final grades between students who did all homework and those who didn\'t: " << endl;
 
-    // Analysis #1: standard grading scheme - incorporates the median of homework grades in the calculation
-    write_analysis("Standard grading scheme", grade_aux, did, didnt);
-
-    // Analysis #2: average homework grading scheme - incorporates the average of homework grades in the calculation
-    write_analysis("Average homework grading scheme", average_grade_aux, did, didnt);
+    // grade each group under every scheme in a single pass over its students (see analysis.h),
+    // with both groups analysed at the same time, each in parallel chunks (see thread_pool.h).
+    Thread_pool pool(jobs);
+    vector<Grading_scheme> ids(scheme_ids, scheme_ids + scheme_count);
+    vector<double> did_medians, didnt_medians;
+    pool.parallel_for(2, 1, [&](size_t group, size_t) {
+        if (group == 0)
+            did_medians = fused_analysis(did, ids, pool);
+        else
+            didnt_medians = fused_analysis(didnt, ids, pool);
+    });
 
-    // Analysis #3: "optimistic" homework grading scheme - uses standard grading scheme, but ignores homework not done.
-    write_analysis("Turned-in homework grading scheme", optimistic_grade, did, didnt);
+    for (int i = 0; i != scheme_count; ++i)
+        write_analysis(scheme_titles[i], did_medians[i], didnt_medians[i]);
     
     return 0;
 }
-/**
- * === ALGORITHMS ===
- * find(iter1, iter2, value) - searches a container bounded by iterators [iter1, iter2) and returns the iterator pointing to the 
- *  first occurance of value in the collection. If not found, then iter2 is returned.
- * -------------------
- * transform(iter1, iter2, iter_out, f) - used to apply a function f to a collection of values bound by the iterators [iter1, iter2), 
- *  writting the outputs into another (or the same) collection starting from the position pointed to by iter_out. 
- * -------------------
- * back_inserter(c) - prepares an iterator that points to the end of a container c, allowing more values to be appended to it.
- * -------------------
- * remove_copy(iter1, iter2, iter_out, val) - traverses over a container bounded by iterators [iter1, iter2) and, without deleting 
- *  values from the original container (hence the "copy"), extracts all values != val to a new (or the same) container 
- *  starting from the position pointed to by iter_out.
- **/
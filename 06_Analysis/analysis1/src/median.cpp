@@ -1,10 +1,13 @@
-#include <algorithm>    // defines std::sort
+#include <algorithm>    // defines std::max_element, std::nth_element and std::sort
 #include <stdexcept>    // defines std::domain_error
 #include <vector>       // defines std::vector
 
+#include "homework_store.h"
 #include "median.h"
 
 using std::domain_error;
+using std::max_element;
+using std::nth_element;
 using std::sort;
 using std::vector;
 
@@ -60,4 +63,28 @@ double median(vector<double> vec)
 
     return size % 2 == 0 ? (vec[mid] + vec[mid-1]) / 2.0 : vec[mid];
 
-}
\ No newline at end of file
+}
+
+/**
+ * Compute the median of the homework grades [b, e) of a student. The grades are copied into a buffer kept
+ * by each thread (so that after the first call, no memory is allocated for them), and only the middle
+ * grade(s) are put in place with nth_element, rather than sorting them all. The result is exactly that
+ * of median(vector<int>).
+ **/
+double median(Hw_span::const_iterator b, Hw_span::const_iterator e)
+{
+    typedef vector<int>::size_type vec_sz;
+    static thread_local vector<int> scratch;
+
+    scratch.assign(b, e);
+    vec_sz size = scratch.size();
+    if (size == 0) {
+        throw domain_error("median of an empty vector");
+    }
+
+    vec_sz mid = size/2;
+    nth_element(scratch.begin(), scratch.begin() + mid, scratch.end());
+
+    // (the grade before the middle one, in sorted order, is the largest of those before it)
+    return size % 2 == 0 ? (scratch[mid] + *max_element(scratch.begin(), scratch.begin() + mid)) / 2.0 : scratch[mid];
+}
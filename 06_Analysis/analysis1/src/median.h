@@ -4,9 +4,12 @@
 
 // median.h
 #include <vector>
+#include "homework_store.h"
 
 
 double median(std::vector<int>);
 double median(std::vector<double>);
+// the median of a student's homework grades, read straight from the homework store
+double median(Hw_span::const_iterator, Hw_span::const_iterator);
 
 #endif
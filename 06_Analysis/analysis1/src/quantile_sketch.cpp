@@ -0,0 +1,164 @@
+#include <algorithm>    // defines std::sort, std::min and std::max
+#include <cmath>        // defines std::ceil and std::pow
+#include <stdexcept>    // defines std::domain_error
+#include <utility>      // defines std::pair
+#include <vector>       // defines std::vector
+
+#include "quantile_sketch.h"
+
+using std::ceil;            using std::pow;
+using std::domain_error;    using std::sort;
+using std::max;             using std::vector;
+using std::min;
+using std::pair;
+
+
+// the ratio between the capacities of one level and the next one up.
+static const double level_ratio = 2.0 / 3.0;
+
+/**
+ * (The rank error of a KLL sketch is roughly 1.7 / k, so the top level is made large enough for
+ * that to be within the error asked for.)
+ **/
+Quantile_sketch::Quantile_sketch(double error): levels(1), odd(1, false), n(0), lo(0), hi(0)
+{
+    if (error <= 0 || error >= 1)
+        throw domain_error("quantile sketch error must be between 0 and 1");
+
+    k = max(size_type(8), size_type(ceil(1.7 / error)));
+}
+
+// the number of values that level h can hold before it must be compacted.
+Quantile_sketch::size_type Quantile_sketch::capacity(size_type h) const
+{
+    // the top level holds k values, with each level below it holding 2/3 as many as the one above.
+    size_type depth = levels.size() - 1 - h;
+    return max(size_type(2), size_type(ceil(k * pow(level_ratio, double(depth)))));
+}
+
+Quantile_sketch::size_type Quantile_sketch::retained() const
+{
+    size_type total = 0;
+    for (size_type h = 0; h != levels.size(); ++h)
+        total += levels[h].size();
+    return total;
+}
+
+void Quantile_sketch::insert(double x)
+{
+    if (n == 0) {
+        lo = hi = x;
+    } else {
+        lo = min(lo, x);
+        hi = max(hi, x);
+    }
+    ++n;
+
+    levels[0].push_back(x);
+    if (levels[0].size() >= capacity(0))
+        compress();
+}
+
+void Quantile_sketch::merge(const Quantile_sketch& other)
+{
+    if (other.n == 0)
+        return;
+    if (n == 0) {
+        lo = other.lo;
+        hi = other.hi;
+    } else {
+        lo = min(lo, other.lo);
+        hi = max(hi, other.hi);
+    }
+    n += other.n;
+
+    // values at the same level of both sketches stand in for the same number of values each.
+    while (levels.size() < other.levels.size()) {
+        levels.push_back(vector<double>());
+        odd.push_back(false);
+    }
+    for (size_type h = 0; h != other.levels.size(); ++h)
+        levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+
+    compress();
+}
+
+// compacts the lowest full level, for as long as the sketch holds more values than it has room for.
+void Quantile_sketch::compress()
+{
+    for (;;) {
+        size_type room = 0;
+        for (size_type h = 0; h != levels.size(); ++h)
+            room += capacity(h);
+        if (retained() < room)
+            return;
+
+        size_type h = 0;
+        while (levels[h].size() < capacity(h))
+            ++h;
+        compact(h);
+    }
+}
+
+/**
+ * Moves every other value of (sorted) level h up to level h + 1, dropping the rest.
+ * (If the level holds an odd number of values, its largest is left behind at level h.)
+ *
+ * Which of each pair is kept, the first or the second, alternates from one compaction of a level
+ * to the next, so that the errors made tend to cancel out rather than add up. (The original KLL
+ * sketch picks at random; alternating keeps the results the same from run to run.)
+ **/
+void Quantile_sketch::compact(size_type h)
+{
+    if (h + 1 == levels.size()) {
+        levels.push_back(vector<double>());
+        odd.push_back(false);
+    }
+
+    vector<double>& level = levels[h];
+    sort(level.begin(), level.end());
+
+    size_type pairs = level.size() / 2;
+    size_type offset = odd[h] ? 1 : 0;
+    odd[h] = !odd[h];
+
+    for (size_type i = 0; i != pairs; ++i)
+        levels[h + 1].push_back(level[2 * i + offset]);
+
+    if (level.size() % 2 == 0) {
+        level.clear();
+    } else {
+        double left = level.back();
+        level.clear();
+        level.push_back(left);
+    }
+}
+
+double Quantile_sketch::quantile(double q) const
+{
+    if (n == 0)
+        throw domain_error("quantile of an empty sketch");
+    if (q <= 0)
+        return lo;
+    if (q >= 1)
+        return hi;
+
+    // pair each value kept with the number of values it stands in for, in order of value.
+    vector<pair<double, unsigned long long> > weighted;
+    weighted.reserve(retained());
+    for (size_type h = 0; h != levels.size(); ++h) {
+        for (size_type i = 0; i != levels[h].size(); ++i)
+            weighted.push_back(pair<double, unsigned long long>(levels[h][i], 1ULL << h));
+    }
+    sort(weighted.begin(), weighted.end());
+
+    // find the first value with (an estimated) fraction q of the values at or below it.
+    double target = q * n;
+    unsigned long long seen = 0;
+    for (vector<pair<double, unsigned long long> >::size_type i = 0; i != weighted.size(); ++i) {
+        seen += weighted[i].second;
+        if (seen >= target)
+            return weighted[i].first;
+    }
+    return hi;
+}
@@ -10,14 +10,14 @@ bool compare(const Student_info& x, const Student_info& y)
     return x.name < y.name;
 }
 
-// read and store midterm and final grades, and homework grades of a single student. 
-istream& read(istream& is, Student_info& s) 
+// read and store midterm and final grades, and homework grades of a single student (adding the homework to a store). 
+istream& read(istream& is, Student_info& s, Homework_store& store) 
 {
     // read and store the student's name and midterm and final grades.
     is >> s.name >> s.midterm >> s.final;
 
     // read and store all the student's homework grades
-    read_hw(is, s.homework);
+    read_hw(is, store, s.homework);
 
     // (We have the function return the stream instead of a Student_info data structure in order to determine
     //  whether the read was successful or not)
@@ -46,4 +46,22 @@ istream& read_hw(istream& in, vector<int>& hw)
     // (We have the function return the stream instead of a vector of the grades in order to determine
     //  whether the read was successful or not)
     return in;
+}
+
+// read homework grades from an input stream onto the end of a store, giving the span of them.
+istream& read_hw(istream& in, Homework_store& store, Hw_span& hw)
+{
+    if (in) {
+        Homework_store::size_type first = store.size();
+
+        int x;
+        // invariant: the store holds every homework grade read so far, after those already in it
+        while (in >> x)
+            store.push_back(x);
+        hw = store.since(first);
+
+        // clear the stream so that input will work for the next student.
+        in.clear();
+    }
+    return in;
 }
\ No newline at end of file
@@ -0,0 +1,158 @@
+#ifndef GUARD_thread_pool_h
+#define GUARD_thread_pool_h
+
+// thread_pool.h
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * =========================
+ * A WORK-STEALING THREAD POOL
+ * =========================
+ * A thread pool starts a fixed number of worker threads once, and then hands them small tasks to run,
+ * rather than starting a new thread for every piece of work.
+ *
+ * Each worker has a queue (a deque) of tasks of its own:
+ *  - a worker adds the tasks it creates to the back of its own queue, and takes its next task from
+ *    the back too (the most recently added, whose data is most likely to still be in its cache).
+ *  - a worker whose queue is empty "steals" a task from the front of another worker's queue.
+ * So the work spreads itself out between the workers, without them all fighting over one queue.
+ *
+ * A thread waiting for its tasks to finish (in parallel_for()) runs queued tasks itself while it waits,
+ * so tasks may start tasks of their own (e.g. analysing both groups at once, each in parallel chunks).
+ **/
+class Thread_pool {
+public:
+    // starts a pool of the given number of threads (with 0 or 1, everything runs on the calling thread).
+    explicit Thread_pool(unsigned threads = std::thread::hardware_concurrency());
+    ~Thread_pool();
+
+    // the number of threads working on the tasks (counting the thread that waits for them).
+    unsigned size() const { return workers.empty() ? 1 : unsigned(workers.size()); }
+
+    /**
+     * Calls f(begin, end) for consecutive chunks [begin, end) of at most 'grain' indices, covering [0, n),
+     * spread across the pool, and waits for all of them to finish. Since which indices make up each chunk
+     * depends only on n and grain (and not on the number of threads), the results can be made the same
+     * however many threads there are.
+     * If any call throws an exception, the first one thrown is re-thrown here once all chunks are done.
+     **/
+    template<class F> void parallel_for(std::size_t n, std::size_t grain, F f);
+
+private:
+    typedef std::function<void()> Task;
+
+    struct Task_queue {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Task_queue> > queues;
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopping;
+    std::atomic<std::size_t> queued;        // the number of tasks waiting in all the queues
+    std::atomic<std::size_t> next_queue;    // where the next task from outside the pool is put
+    std::mutex sleep_lock;
+    std::condition_variable wake;
+
+    void submit(Task);
+    bool run_one();
+    void work(unsigned);
+
+    // (copying a pool would make no sense)
+    Thread_pool(const Thread_pool&);
+    Thread_pool& operator=(const Thread_pool&);
+};
+
+template<class F> void Thread_pool::parallel_for(std::size_t n, std::size_t grain, F f)
+{
+    if (grain == 0)
+        grain = 1;
+
+    // without any workers, or with only a single chunk, there is nothing to share out.
+    if (workers.empty() || n <= grain) {
+        for (std::size_t b = 0; b < n; b += grain)
+            f(b, b + grain < n ? b + grain : n);
+        return;
+    }
+
+    std::size_t chunks = (n + grain - 1) / grain;
+    std::atomic<std::size_t> remaining(chunks);
+    std::exception_ptr error;
+    std::mutex error_lock;
+
+    for (std::size_t c = 0; c != chunks; ++c) {
+        std::size_t b = c * grain, e = b + grain < n ? b + grain : n;
+        submit([&, b, e]() {
+            try {
+                f(b, e);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(error_lock);
+                if (!error)
+                    error = std::current_exception();
+            }
+            remaining.fetch_sub(1, std::memory_order_acq_rel);
+        });
+    }
+
+    // help with the queued tasks (ours or anyone's) until every chunk is done.
+    while (remaining.load(std::memory_order_acquire) != 0) {
+        if (!run_one())
+            std::this_thread::yield();
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+/**
+ * out[i] = f(b[i]) for every element of the (random-access) range [b, e), computed in parallel chunks.
+ * Each result goes to the same position as it would in std::transform, so the output is identical.
+ **/
+template<class In, class Out, class F>
+void parallel_transform(Thread_pool& pool, In b, In e, Out out, F f, std::size_t grain = 1024)
+{
+    pool.parallel_for(e - b, grain, [=](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i != last; ++i)
+            out[i] = f(b[i]);
+    });
+}
+
+/**
+ * Combines map(x) for every element x of the (random-access) range [b, e), starting from init.
+ * Each chunk of 'grain' elements is reduced in parallel, then the partial results are combined in order
+ * from the first chunk to the last. So as long as the grain is the same, the result is the same however
+ * many threads there are. (For an associative combine, such as adding integers, it is the same as a
+ * serial loop too.)
+ **/
+template<class In, class T, class Map, class Combine>
+T parallel_reduce(Thread_pool& pool, In b, In e, T init, Map map, Combine combine, std::size_t grain = 1024)
+{
+    std::size_t n = e - b;
+    if (n == 0)
+        return init;
+    if (grain == 0)
+        grain = 1;
+
+    std::vector<T> partial((n + grain - 1) / grain);
+    pool.parallel_for(n, grain, [&](std::size_t first, std::size_t last) {
+        T acc = map(b[first]);
+        for (std::size_t i = first + 1; i != last; ++i)
+            acc = combine(acc, map(b[i]));
+        partial[first / grain] = acc;
+    });
+
+    for (typename std::vector<T>::size_type i = 0; i != partial.size(); ++i)
+        init = combine(init, partial[i]);
+    return init;
+}
+
+#endif
@@ -16,16 +16,40 @@ double grade(int midterm, int final, double homework)
     return 0.2 * midterm + 0.4 * final + 0.4 * homework;
 }
 
-// compute a student's overall grade from midterm and final exam grades
-// and vector of homework grades.
+// try to compute a student's overall grade from midterm and final exam grades
+// and vector of homework grades, without throwing an exception if it cannot be done.
 // this function does not copy its argument (i.e. it is called by reference), because median does so for us anyway.
-double grade(int midterm, int final, const vector<int>& hw)
+Grade_result try_grade(int midterm, int final, const vector<int>& hw)
 {
+    Grade_result result;
+
     // if the size of the hw vector is zero, then there is no data that can be used to calculate the homework grades.
-    if (hw.size()== 0)
-        throw domain_error("student has done no homework");
+    if (hw.size() == 0) {
+        result.ok = false;
+        result.value = 0;
+        result.error = "student has done no homework";
+    } else {
+        result.ok = true;
+        result.value = grade(midterm, final, median(hw));
+        result.error = 0;
+    }
+    return result;
+}
+
+Grade_result try_grade(const Student_info& s)
+{
+    return try_grade(s.midterm, s.final, s.homework);
+}
+
+// compute a student's overall grade from midterm and final exam grades
+// and vector of homework grades, throwing a domain_error if it cannot be done.
+double grade(int midterm, int final, const vector<int>& hw)
+{
+    Grade_result result = try_grade(midterm, final, hw);
+    if (!result.ok)
+        throw domain_error(result.error);
     
-    return grade(midterm, final, median(hw));
+    return result.value;
 }
 
 double grade(const Student_info& s)
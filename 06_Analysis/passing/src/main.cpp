@@ -28,14 +28,14 @@ void output_grades(const vector<Student_info>& students, const string::size_type
         cout << (*iter).name
              << string(pad_factor + 1 - (*iter).name.size(), ' ');
 
-        // compute and write the grade
-        try {
-            double final_grade = grade(*iter);
+        // compute and write the grade (or why there is none)
+        Grade_result result = try_grade(*iter);
+        if (result.ok) {
             streamsize prec = cout.precision();
-            cout << setprecision(3) << final_grade
+            cout << setprecision(3) << result.value
                  << setprecision(prec);
-        } catch (domain_error e) {
-            cout << e.what();
+        } else {
+            cout << result.error;
         }
         cout << endl;
     }
@@ -44,13 +44,10 @@ void output_grades(const vector<Student_info>& students, const string::size_type
 // we need a single predicate to work with the "remove_if" functions and stable_partition()
 bool pgrade(const Student_info& s)
 {   
-    try {
-        return !fgrade(s);
-    } 
-    // if there is a domain error (due to insufficient grades) automaically mark student grade as a fail.
-    catch (domain_error) {
-        return false;
-    }
+    // if there are insufficient grades, automatically mark student grade as a fail.
+    // (checked through try_grade() rather than by catching the domain_error that fgrade() would throw)
+    Grade_result result = try_grade(s);
+    return result.ok && result.value >= 60;
 }
 
 /**
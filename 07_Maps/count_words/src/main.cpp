@@ -5,6 +5,8 @@
 #include <map>
 #include <string>
 
+#include "profile.h"
+
 using std::cin;
 using std::cout;
 using std::endl;
@@ -24,8 +26,16 @@ string pad_str(string s, string::size_type pad_factor)
 
 }
 
-int main()
+/**
+ * Options:
+ *  --profile  time the stages of the run, writing a summary to "profile.json" and a trace
+ *             to "profile.trace.json" (see profile.h).
+ **/
+int main(int argc, char** argv)
 {
+    // (the profile is written when this goes out of scope, as main() returns)
+    Profile_session profile_session(argc > 1 && string(argv[1]) == "--profile", "profile.json", "profile.trace.json");
+
     // declare string used to read user input into.
     string s;
     // store each word and associated counter
@@ -38,25 +48,29 @@ int main()
             "followed by end-of-file: " << endl;
     
     // read the input, keeping track of each word and how often we see it
-    while (cin >> s) {
+    { // (a block of its own, to time only the reading)
+        Profile_scope timer("count_words");
+        while (cin >> s) {
+            profile_count("words");
 
-        // remove any punctiuation symbols surrounding the word
-        while(!s.empty() && ispunct(s[0]))
-        {
-            s.erase(0);
-        }
-        while(!s.empty() && ispunct(s[s.size() - 1]))
-        {
-            s.erase(s.size() - 1);
-        }
+            // remove any punctiuation symbols surrounding the word
+            while(!s.empty() && ispunct(s[0]))
+            {
+                s.erase(0);
+            }
+            while(!s.empty() && ispunct(s[s.size() - 1]))
+            {
+                s.erase(s.size() - 1);
+            }
 
-        if (!s.empty()) {
-            maxlen = max(maxlen, s.size());
-            // using the word as a key, increment the count of the word
-            // (if the map does not yet have the key, it is created first with initial value 0)
-            ++counters[s];
-        }
+            if (!s.empty()) {
+                maxlen = max(maxlen, s.size());
+                // using the word as a key, increment the count of the word
+                // (if the map does not yet have the key, it is created first with initial value 0)
+                ++counters[s];
+            }
 
+        }
     }
     cout << endl;
 
@@ -69,6 +83,7 @@ int main()
     }
 
     cout << "Number of times each distinct word appears: " << endl;
+    Profile_scope timer("write_counts");
     // write the words and associated counts
     // (note that the iterator will automatically iterate over the key-value pairs in key-alphabetical order)
     for (map<string, int>::const_iterator it = counters.begin();
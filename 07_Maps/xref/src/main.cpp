@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "pad_str.h"
+#include "profile.h"
 #include "remove_punct.h"
 #include "split.h"
 
@@ -37,6 +38,8 @@ map<string, vector<int> > xref(istream& in, vector<string> find_words(const stri
         
     maxlen = 0;
 
+    Profile_scope timer("xref");
+
     // read the next line
     while (getline(in, line)) {
 
@@ -59,14 +62,24 @@ map<string, vector<int> > xref(istream& in, vector<string> find_words(const stri
             maxlen = max(maxlen, s.size() + 2); 
             ret[s].push_back(line_number);
         }
+        profile_count("words", words.size());
 
     }
+    profile_count("lines", line_number);
     return ret;
 
 }
 
-int main()
+/**
+ * Options:
+ *  --profile  time the stages of the run, writing a summary to "profile.json" and a trace
+ *             to "profile.trace.json" (see profile.h).
+ **/
+int main(int argc, char** argv)
 {
+    // (the profile is written when this goes out of scope, as main() returns)
+    Profile_session profile_session(argc > 1 && string(argv[1]) == "--profile", "profile.json", "profile.trace.json");
+
     // prompt the user
     cout << "Input lines of text, "
             "followed by end-of-file, " 
@@ -90,6 +103,7 @@ int main()
     cout << "=====================" << endl;
 
     // write the results
+    Profile_scope timer("write_refs");
     for (map<string, vector<int> >::const_iterator it = refs.begin();
          it != refs.end(); ++it){
 
@@ -6,11 +6,27 @@
 #include "grade.h"
 #include "Student_info.h"
 
+/**
+ * The result of trying to calculate a grade: either the grade itself, or the reason it could not be calculated.
+ * Unlike grade(), which throws a domain_error when a student cannot be graded, try_grade() never throws, but
+ * returns a Grade_result that is not ok instead. (Throwing and catching an exception is very slow compared with
+ * checking a flag, so this is the version to use for students who may well have no homework.)
+ **/
+struct Grade_result {
+    bool ok;            // whether the grade could be calculated
+    double value;       // the grade (only if ok)
+    const char* error;  // the reason there is no grade (only if not ok)
+};
+
 double grade(int, int, double);
 double grade(int, int, const std::vector<int>&);
 double grade(const Student_info&);
 double average_grade(int, int, const std::vector<int>&);
 double average_grade(const Student_info&);
 bool fgrade(const Student_info&);
+Grade_result try_grade(int, int, const std::vector<int>&);
+Grade_result try_grade(const Student_info&);
+Grade_result try_average_grade(int, int, const std::vector<int>&);
+Grade_result try_average_grade(const Student_info&);
 
 #endif
\ No newline at end of file
@@ -1,15 +1,19 @@
 #include <algorithm>    // std::find, std::remove_copy, std::transform
+#include <cstddef>      // std::size_t
+#include <cstdlib>      // std::strtol
 #include <iomanip>      // defines std::setprecision
 #include <ios>          // defines std::streamsize
 #include <iostream>     // std::cin, std::cout, std::endl
 #include <iterator>     // std::back_inserter
 #include <stdexcept>    // std::domain_error
 #include <string>       // std::string
+#include <thread>       // std::thread
 #include <vector>       // std::vector
 
 #include "grade.h"
 #include "median.h"
 #include "Student_info.h"
+#include "thread_pool.h"
 
 using std::back_inserter;       using std::find;
 using std::cin;                 using std::remove_copy;
@@ -18,6 +22,9 @@ using std::domain_error;        using std::transform;
 using std::endl;                using std::vector;
 using std::streamsize;
 using std::setprecision;
+using std::size_t;
+using std::strtol;
+using std::thread;
 
 
 // The homework is counted as "all done" if the homework vector is non-empty, and none of its values are zero.
@@ -34,11 +41,9 @@ bool did_all_hw(const Student_info& s)
  **/
 double grade_aux(const Student_info& s)
 {
-    try {
-        return grade(s);
-    } catch (domain_error) {
-        return grade(s.midterm, s.final, 0);
-    }
+    // (checked through try_grade() rather than by catching the domain_error that grade() would throw)
+    Grade_result result = try_grade(s);
+    return result.ok ? result.value : grade(s.midterm, s.final, 0);
 }
 
 /**
@@ -47,11 +52,8 @@ double grade_aux(const Student_info& s)
  **/
 double average_grade_aux(const Student_info& s)
 {
-    try {
-        return average_grade(s);
-    } catch (domain_error) {
-        return grade(s.midterm, s.final, 0);
-    }
+    Grade_result result = try_average_grade(s);
+    return result.ok ? result.value : grade(s.midterm, s.final, 0);
 }
 
 /**
@@ -77,21 +79,30 @@ double optimistic_grade(const Student_info& s)
  * The mainline analysis function, taking as input a vector of student records,
  * and calculates their final grades using a given grading scheme, and returns the median of these grades.
  **/
-double analysis(const vector<Student_info>& students, double grading_scheme(const Student_info&))
+double analysis(const vector<Student_info>& students, double grading_scheme(const Student_info&), Thread_pool& pool)
 {
-    vector<double> grades;
-    transform(students.begin(), students.end(),
-              back_inserter(grades), grading_scheme);
-
-    return median<double>(grades.begin(), grades.end());
+    // grade the students in parallel chunks, each grade going to the same place that transform() would put it.
+    vector<double> grades(students.size());
+    parallel_transform(pool, students.begin(), students.end(), grades.begin(), grading_scheme);
+
+    // (the grades are not needed afterwards, so the median can re-order them in place)
+    if (grades.empty())
+        throw domain_error("median of an empty container");
+    return median_in_place(&grades[0], grades.size());
 }
 /**
  * This procedure is used to output the results of an analysis comparing the final grades of students who did all 
  * their homework with students who have not, under a given grading scheme
  **/
 void write_analysis(const string title, double grading_scheme(const Student_info&),
-                    const vector<Student_info>& did_hw, const vector<Student_info>& didnt_hw)
+                    const vector<Student_info>& did_hw, const vector<Student_info>& didnt_hw, Thread_pool& pool)
 {
+    // analyse both groups at the same time (see thread_pool.h)
+    double medians[2];
+    pool.parallel_for(2, 1, [&](size_t group, size_t) {
+        medians[group] = analysis(group == 0 ? did_hw : didnt_hw, grading_scheme, pool);
+    });
+
     streamsize prec = cout.precision();
 
     cout << "\n(" << title << ") - median final grade of students who:" << endl;
@@ -99,14 +110,40 @@ void write_analysis(const string title, double grading_scheme(const Student_info
     // set results to three significant figures
     cout << setprecision(3);
 
-    cout << "Did all homework:       " << analysis(did_hw, grading_scheme) << endl;
-    cout << "Didn't do all homework: " << analysis(didnt_hw, grading_scheme) << endl;
+    cout << "Did all homework:       " << medians[0] << endl;
+    cout << "Didn't do all homework: " << medians[1] << endl;
 
     cout << setprecision(prec);
 }
 
-int main()
+// the most threads that may be asked for with "--jobs"
+const long max_jobs = 256;
+
+/**
+ * Reads the whole of an argument as a number of threads, from 1 to max_jobs. Returns false
+ * (leaving n unchanged) if it is not one.
+ **/
+bool parse_jobs(const char* s, unsigned& n)
+{
+    char* end;
+    long x = strtol(s, &end, 10);
+    if (end == s || *end != '\0' || x < 1 || x > max_jobs)
+        return false;
+    n = unsigned(x);
+    return true;
+}
+
+int main(int argc, char** argv)
 {
+    // "--jobs N" sets the number of threads to analyse with (by default, one for each processor core).
+    unsigned jobs = thread::hardware_concurrency();
+    if (argc > 2 && string(argv[1]) == "--jobs" && !parse_jobs(argv[2], jobs)) {
+        cout << "Invalid number of threads for '--jobs' ('" << argv[2] << "')." << endl;
+        cout << "Usage: main [--jobs N]   (with 1 <= N <= 256)" << endl;
+        return 1;
+    }
+    Thread_pool pool(jobs);
+
     // students who did and didn't do all their homework
     vector<Student_info> did, didnt;
     Student_info student;
@@ -139,13 +176,13 @@ int main()
     cout << "\nComparing the final grades between students who did all homework and those who didn\'t: " << endl;
 
     // Analysis #1: standard grading scheme - incorporates the median of homework grades in the calculation
-    write_analysis("Standard grading scheme", grade_aux, did, didnt);
+    write_analysis("Standard grading scheme", grade_aux, did, didnt, pool);
 
     // Analysis #2: average homework grading scheme - incorporates the average of homework grades in the calculation
-    write_analysis("Average homework grading scheme", average_grade_aux, did, didnt);
+    write_analysis("Average homework grading scheme", average_grade_aux, did, didnt, pool);
 
     // Analysis #3: "optimistic" homework grading scheme - uses standard grading scheme, but ignores homework not done.
-    write_analysis("Turned-in homework grading scheme", optimistic_grade, did, didnt);
+    write_analysis("Turned-in homework grading scheme", optimistic_grade, did, didnt, pool);
     
     return 0;
 }
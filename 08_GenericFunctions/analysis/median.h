@@ -3,11 +3,9 @@
 #define GUARD_median_h
 
 // median.h
-#include <algorithm>    // defines std::sort and std::max
-#include <cstddef>      // defines std::ptrdiff_t
 #include <stdexcept>    // defines std::domain_error
-#include <vector>       // defines std::domain_error
-#include <iostream>
+
+#include "order_stats.h"
 
 
 /**
@@ -25,24 +23,13 @@ double median(Ran b, Ran e)
         throw std::domain_error("median of an empty container");
     }
 
-    // use a copy of the sequence to prevent the original from being modified.
-    std::vector<T> v(b, e);
-    
-    // get the size of the sequence by calculating the distance between the iterators.
-    std::size_t size = v.size();
-
-    // use the size to calculate the midpoint of the sequence.
-    std::size_t mid  = size / 2;
-    
-    // ensure the sequence is sorted to ensure a correct result.
-    std::sort(v.begin(), v.end());
-
     /**
-     * Calculate the median: 
-     * - If the size is even, then the median is equal to the sum of the value in the mid position and the previous one.
-     * - Otherwise (if size is odd), the median is equal to the element in the mid position.
+     * Select the median from a copy of the sequence, to prevent the original from being modified.
+     * Rather than a new vector for every call, each thread keeps a scratch buffer of its own
+     * (see order_stats.h), and the copy is only partly ordered rather than fully sorted.
      **/
-    return size % 2 == 0 ?  (v[mid] + v[mid-1]) / 2.0 : v[mid];
+    static thread_local Order_stats<T> stats;
+    return stats.median(b, e);
 }
 
 #endif
@@ -0,0 +1,106 @@
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "thread_pool.h"
+
+using std::condition_variable;  using std::thread;
+using std::lock_guard;          using std::unique_lock;
+using std::mutex;
+
+
+// the index of the pool worker running on this thread, or -1 if this thread is not a worker.
+// (so that tasks submitted from a worker go on its own queue)
+static thread_local int worker_index = -1;
+static thread_local const Thread_pool* worker_pool = 0;
+
+Thread_pool::Thread_pool(unsigned threads): stopping(false), queued(0), next_queue(0)
+{
+    // a single thread would only ever run tasks one at a time anyway, so no workers are needed.
+    if (threads < 2)
+        return;
+
+    for (unsigned i = 0; i != threads; ++i)
+        queues.push_back(std::unique_ptr<Task_queue>(new Task_queue));
+    for (unsigned i = 0; i != threads; ++i)
+        workers.push_back(thread(&Thread_pool::work, this, i));
+}
+
+Thread_pool::~Thread_pool()
+{
+    {
+        lock_guard<mutex> guard(sleep_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::vector<thread>::size_type i = 0; i != workers.size(); ++i)
+        workers[i].join();
+}
+
+void Thread_pool::submit(Task task)
+{
+    // a worker adds to its own queue; anyone else spreads their tasks around the queues in turn.
+    std::size_t q = (worker_pool == this && worker_index >= 0) ?
+        std::size_t(worker_index) : next_queue.fetch_add(1) % queues.size();
+    {
+        lock_guard<mutex> guard(queues[q]->lock);
+        queues[q]->tasks.push_back(std::move(task));
+    }
+    {
+        lock_guard<mutex> guard(sleep_lock);
+        ++queued;
+    }
+    wake.notify_one();
+}
+
+/**
+ * Runs a single queued task, if there is one: from the back of this worker's own queue if it has any,
+ * otherwise stolen from the front of another queue. Returns false if every queue was empty.
+ **/
+bool Thread_pool::run_one()
+{
+    std::size_t self = (worker_pool == this && worker_index >= 0) ? std::size_t(worker_index) : 0;
+    Task task;
+
+    for (std::size_t i = 0; i != queues.size() && !task; ++i) {
+        std::size_t q = (self + i) % queues.size();
+        lock_guard<mutex> guard(queues[q]->lock);
+        std::deque<Task>& tasks = queues[q]->tasks;
+        if (tasks.empty())
+            continue;
+
+        if (i == 0 && worker_pool == this && worker_index >= 0) {
+            task = std::move(tasks.back());
+            tasks.pop_back();
+        } else {
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+    }
+
+    if (!task)
+        return false;
+    --queued;
+    task();
+    return true;
+}
+
+// the body of each worker thread: run tasks until the pool is destroyed, sleeping while there are none.
+void Thread_pool::work(unsigned index)
+{
+    worker_index = int(index);
+    worker_pool = this;
+
+    for (;;) {
+        if (run_one())
+            continue;
+
+        unique_lock<mutex> guard(sleep_lock);
+        // (the timeout is only a safety net; submit() wakes a worker for every new task)
+        wake.wait_for(guard, std::chrono::milliseconds(10), [this] { return stopping || queued != 0; });
+        if (stopping && queued == 0)
+            return;
+    }
+}
@@ -0,0 +1,274 @@
+#include <algorithm>
+using std::max;
+using std::min;
+
+#include <cstdio>
+using std::remove;
+
+#include <fstream>
+using std::ifstream;
+using std::ofstream;
+
+#include <iomanip>
+using std::setprecision;
+
+#include <iostream>
+using std::cin;
+using std::cout;
+using std::endl;
+using std::istream;
+using std::ostream;
+
+#include <queue>
+using std::priority_queue;
+
+#include <sstream>
+using std::ostringstream;
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "External_sort.h"
+#include "Name_sort.h"
+#include "Option.h"
+#include "Profile.h"
+#include "Stream.h"
+#include "Student_info.h"
+
+typedef string::size_type str_sz;
+
+
+// the number of runs merged at once (so that only this many run files are ever open together)
+static const vector<string>::size_type merge_width = 64;
+
+/**
+ * A run file holds one record per line: the name, whether the record is valid, and the grade
+ * (written with enough digits that it is read back exactly).
+ **/
+void write_run_record(ostream& out, const Student_info& s)
+{
+    out << s.name() << ' ' << s.valid() << ' ' << (s.valid() ? s.grade() : 0.0) << '\n';
+}
+
+// writes the records, sorted by name, as a run file, returning false if it could not be written
+bool write_run(const string& path, vector<Student_info>& students)
+{
+    sort_by_name(students);
+
+    ofstream out(path.c_str());
+    out << setprecision(17);
+    for (vector<Student_info>::const_iterator s = students.begin(); s != students.end(); ++s)
+        write_run_record(out, *s);
+    return bool(out.flush());
+}
+
+// reads the next record of a run file, returning false once it runs out
+bool read_run_record(istream& in, Student_info& s)
+{
+    string name;
+    bool valid;
+    double g;
+    if (in >> name >> valid >> g) {
+        s = Student_info(name, g, valid);
+        return true;
+    }
+    return false;
+}
+
+// the approximate number of bytes a record takes up in memory
+size_t record_bytes(const Student_info& s)
+{
+    return sizeof(Student_info) + s.name().capacity();
+}
+
+// the name of the n-th run file (named after the output file)
+string run_path(const string& out_path, vector<string>::size_type n)
+{
+    ostringstream path;
+    path << out_path << ".run" << n << ".tmp";
+    return path.str();
+}
+
+// write the records held so far as a new run, and let them go.
+bool spill_run(vector<string>& runs, vector<string>::size_type& made, vector<Student_info>& held,
+               size_t& held_bytes, const string& out_path)
+{
+    Profile_scope timer("spill_run");
+    runs.push_back(run_path(out_path, made++));
+
+    bool ok = write_run(runs.back(), held);
+    held.clear();
+    held_bytes = 0;
+    return ok;
+}
+
+/**
+ * The front record of one of the runs being merged. The runs are ordered so that the
+ * priority_queue (which gives its *largest* element first) gives the alphabetically-first name,
+ * with ties going to the earlier run.
+ **/
+struct Run_head {
+    Student_info record;
+    vector<ifstream>::size_type run;
+};
+
+bool operator<(const Run_head& x, const Run_head& y)
+{
+    if (compare(x.record, y.record))
+        return false;
+    if (compare(y.record, x.record))
+        return true;
+    return x.run > y.run;
+}
+
+/**
+ * Merges the runs [b, e) (k-way), by repeatedly taking the alphabetically-first record from the
+ * front of any run, and passing every record, in order, to 'emit'. Returns false if some run could
+ * not be opened or read to its end.
+ **/
+template<class F>
+bool merge_runs(vector<string>::const_iterator b, vector<string>::const_iterator e, F emit)
+{
+    Profile_scope timer("merge_runs");
+    vector<ifstream> in(e - b);
+    priority_queue<Run_head> heads;
+    for (vector<ifstream>::size_type i = 0; i != in.size(); ++i) {
+        in[i].open(b[i].c_str());
+        if (!in[i])
+            return false;
+        Run_head h;
+        h.run = i;
+        if (read_run_record(in[i], h.record))
+            heads.push(h);
+    }
+
+    while (!heads.empty()) {
+        Run_head h = heads.top();
+        heads.pop();
+        emit(h.record);
+
+        // replace the record taken with the next one from the same run.
+        if (read_run_record(in[h.run], h.record))
+            heads.push(h);
+    }
+
+    // (every run should have been read up to its end, and not just up to something it could not read)
+    for (vector<ifstream>::size_type i = 0; i != in.size(); ++i)
+        if (in[i].bad() || !in[i].eof())
+            return false;
+    return true;
+}
+
+// removes every run file
+void remove_runs(const vector<string>& runs)
+{
+    for (vector<string>::const_iterator r = runs.begin(); r != runs.end(); ++r)
+        remove(r->c_str());
+}
+
+int sort_records_external(const vector<string>& files, const string& out_path, const Option& opt,
+                          size_t memory_budget)
+{
+    int fail_count = 0;
+    str_sz maxlen = 0;
+
+    vector<string> runs;
+    vector<string>::size_type made = 0;     // (the number of run files made, to name the next one)
+    vector<Student_info> held;
+    size_t held_bytes = 0;
+    bool ok = true;
+
+    // -------- 1) read, grade, and write sorted runs --------
+    vector<string> inputs = files;
+    bool use_cin = inputs.empty();
+    if (use_cin)
+        inputs.push_back("");
+
+    for (vector<string>::const_iterator f = inputs.begin(); ok && f != inputs.end(); ++f) {
+        ifstream file;
+        if (!use_cin) {
+            file.open(f->c_str());
+            if (!file) {
+                cout << "Could not open \'" << *f << "\'." << endl;
+                ++fail_count;
+                continue;
+            }
+        }
+        istream& in = use_cin ? cin : file;
+
+        Student_info record;
+        while (ok && record.read(in)) {
+            profile_count("records read");
+            maxlen = max(maxlen, record.name().size());
+            held_bytes += record_bytes(record);
+            held.push_back(record);
+
+            if (held_bytes >= memory_budget)
+                ok = spill_run(runs, made, held, held_bytes, out_path);
+        }
+    }
+    if (ok && !held.empty())
+        ok = spill_run(runs, made, held, held_bytes, out_path);
+    // (give the memory back before merging)
+    vector<Student_info>().swap(held);
+
+    // -------- 2) merge the runs, at most 'merge_width' at a time --------
+    // while there are too many runs to merge at once, each group of them is merged into a longer run.
+    while (ok && runs.size() > merge_width) {
+        vector<string> merged;
+        for (vector<string>::size_type i = 0; ok && i < runs.size(); i += merge_width) {
+            vector<string>::const_iterator b = runs.begin() + i;
+            vector<string>::const_iterator e = runs.size() - i > merge_width ? b + merge_width : runs.end();
+            merged.push_back(run_path(out_path, made++));
+
+            ofstream out(merged.back().c_str());
+            out << setprecision(17);
+            ok = out && merge_runs(b, e, [&out](const Student_info& s) { write_run_record(out, s); }) &&
+                 out.flush();
+            remove_runs(vector<string>(b, e));
+        }
+        // (the runs of any group not merged, after a failure, are still to be removed)
+        if (!ok)
+            remove_runs(vector<string>(runs.begin() + min(runs.size(), merged.size() * merge_width), runs.end()));
+        runs.swap(merged);
+    }
+
+    // the last merge writes the report itself.
+    if (ok) {
+        ofstream out(out_path.c_str());
+        if (!out)
+            ok = false;
+        else {
+            {
+                Report_writer writer(out, opt.f, maxlen, out_path + ".fails.tmp");
+
+                // the records are written in small batches, to reuse the writer's batch interface.
+                vector<Student_info> batch;
+                ok = merge_runs(runs.begin(), runs.end(), [&](const Student_info& s) {
+                    batch.push_back(s);
+                    if (batch.size() == 4096) {
+                        writer.write(batch.begin(), batch.end());
+                        batch.clear();
+                    }
+                });
+                writer.write(batch.begin(), batch.end());
+                writer.finish();
+            }
+            ok = ok && out.flush();
+
+            // (a report missing some of the records is not left behind)
+            if (!ok) {
+                out.close();
+                remove(out_path.c_str());
+            }
+        }
+    }
+
+    // clean up the runs.
+    remove_runs(runs);
+
+    return ok ? fail_count : -1;
+}
@@ -0,0 +1,35 @@
+#ifndef GUARD_External_sort_h
+#define GUARD_External_sort_h
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Option.h"
+
+/**
+ * ===================
+ * EXTERNAL MERGE SORT
+ * ===================
+ * Writes the same (alphabetical) report as the usual mode, but without ever holding more than
+ * a fixed amount of records in memory, so that rosters larger than the memory available can
+ * still be processed:
+ *
+ * 1) Records are read and graded one at a time. Once the records held take up more than
+ *    'memory_budget' bytes, they are sorted by name and written to a temporary "run" file,
+ *    and memory is cleared to hold the next ones.
+ * 2) The runs are merged (k-way) by repeatedly taking the alphabetically-first record from the
+ *    front of any of them, which gives every record in order. At most 64 runs are merged at once
+ *    (so the number of files open stays bounded); while there are more, each group of 64 is first
+ *    merged into a single longer run, in as many passes as it takes. The last merge writes the
+ *    records through a Report_writer, which splits off the failing records for the "PASS + FAIL"
+ *    option as they go by.
+ *
+ * Only text rosters are read. Returns the number of input files that could not be opened, or -1
+ * if the report could not be written (if some run file could not be written or read back, or the
+ * output file could not be written), in which case no output file is left behind.
+ **/
+int sort_records_external(const std::vector<std::string>& files, const std::string& out_path,
+                          const Option&, std::size_t memory_budget);
+
+#endif
@@ -0,0 +1,326 @@
+#include <algorithm>
+using std::count;
+using std::lower_bound;
+using std::max;
+using std::sort;
+
+#include <cstddef>
+using std::size_t;
+
+#include <cstdio>
+using std::remove;
+using std::rename;
+
+#include <cstring>
+using std::memchr;
+using std::memcmp;
+using std::memcpy;
+
+#include <fstream>
+using std::ifstream;
+using std::ofstream;
+
+#include <iostream>
+using std::istream;
+using std::ostream;
+using std::ws;
+
+#include <mutex>
+using std::lock_guard;
+using std::mutex;
+
+#include <sstream>
+using std::istringstream;
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "Grade_cache.h"
+#include "Grader.h"
+#include "Profile.h"
+#include "Student_info.h"
+
+typedef string::size_type str_sz;
+typedef unsigned long long u64;
+
+static const char grade_cache_magic[4] = { 'S', 'G', 'C', '1' };
+
+// the version of the layout described in Grade_cache.h
+static const unsigned grade_cache_version = 1;
+
+// the header found at the start of every cache file
+struct Grade_cache_header {
+    char magic[4];
+    unsigned version;
+    u64 count;          // number of entries
+    double probe;       // the grade of the probe record, as graded by the program that wrote the cache
+};
+
+/**
+ * The grade of a fixed, made-up record, as this program grades it. A cache is only used if the program
+ * that wrote it gave the same grade, so changing how records are graded does not leave old grades in use.
+ **/
+static double probe_grade()
+{
+    const int hw[] = { 91, 64, 100, 57, 83 };
+    return Standard_grader::grade(73, 88, hw, hw + 5);
+}
+
+// ================= "Helper" functions for writing and reading columns ===================
+
+template<class T>
+static void write_column(ostream& out, const vector<T>& v)
+{
+    if (!v.empty())
+        out.write(reinterpret_cast<const char*>(&v[0]), v.size() * sizeof(T));
+}
+
+template<class T>
+static bool read_column(istream& in, vector<T>& v, u64 n)
+{
+    v.resize(n);
+    if (n != 0)
+        in.read(reinterpret_cast<char*>(&v[0]), n * sizeof(T));
+    return bool(in);
+}
+
+// ================= The cache ===================
+
+Grade_cache::Grade_cache(): hit_count(0), line_count(0) { }
+
+// the number of buckets of the index (one for each value of the top 16 bits of a key)
+static const unsigned bucket_count = 1 << 16;
+
+// whether the index and its buckets only point within the entries (so that a damaged cache is never followed)
+static bool index_fits(const vector<unsigned>& index, const vector<unsigned>& buckets)
+{
+    for (vector<unsigned>::size_type t = 0; t != bucket_count; ++t)
+        if (buckets[t] > buckets[t + 1])
+            return false;
+    if (buckets[0] != 0 || buckets[bucket_count] != index.size())
+        return false;
+    for (vector<unsigned>::const_iterator i = index.begin(); i != index.end(); ++i)
+        if (*i >= index.size())
+            return false;
+    return true;
+}
+
+bool Grade_cache::load(const string& path)
+{
+    Profile_scope timer("load_cache");
+    ifstream in(path.c_str(), std::ios::binary);
+    Grade_cache_header h;
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h)) || memcmp(h.magic, grade_cache_magic, 4) != 0 ||
+        h.version != grade_cache_version || h.probe != probe_grade())
+        return false;
+
+    // (the number of entries must account for exactly the rest of the file, before any room is made for them)
+    const u64 entry_bytes = sizeof(u64) + sizeof(double) + sizeof(unsigned char) + sizeof(unsigned);
+    const u64 bucket_bytes = u64(bucket_count + 1) * sizeof(unsigned);
+    std::streamoff start = in.tellg();
+    in.seekg(0, std::ios::end);
+    std::streamoff end = in.tellg();
+    in.seekg(start);
+    if (start < 0 || end < start || u64(end - start) < bucket_bytes ||
+        (u64(end - start) - bucket_bytes) / entry_bytes != h.count ||
+        (u64(end - start) - bucket_bytes) % entry_bytes != 0 || h.count > 0xffffffffULL)
+        return false;
+
+    if (!read_column(in, keys, h.count) || !read_column(in, grades, h.count) || !read_column(in, valid, h.count) ||
+        !read_column(in, index, h.count) || !read_column(in, buckets, bucket_count + 1) ||
+        !index_fits(index, buckets)) {
+        keys.clear();
+        grades.clear();
+        valid.clear();
+        index.clear();
+        buckets.clear();
+        return false;
+    }
+    return true;
+}
+
+bool Grade_cache::find(u64 key, Cache_entry& entry, size_t& next) const
+{
+    if (keys.empty())
+        return false;
+
+    // the line after the one last found is most likely the next line of the same file,
+    size_t i = next;
+    if (i >= keys.size() || keys[i] != key) {
+        // but if not, look it up in the index (only searching the keys with the same top 16 bits).
+        unsigned t = unsigned(key >> 48);
+        vector<unsigned>::const_iterator b = index.begin() + buckets[t], e = index.begin() + buckets[t + 1];
+        vector<unsigned>::const_iterator it = lower_bound(b, e, key, [this](unsigned pos, u64 k) {
+            return keys[pos] < k;
+        });
+        if (it == e || keys[*it] != key)
+            return false;
+        i = *it;
+    }
+
+    entry.key = key;
+    entry.grade = grades[i];
+    entry.valid = valid[i] != 0;
+    next = i + 1;
+    return true;
+}
+
+void Grade_cache::use(const vector<Cache_entry>& entries, long long hits)
+{
+    lock_guard<mutex> guard(use_lock);
+    used.insert(used.end(), entries.begin(), entries.end());
+    hit_count += hits;
+    line_count += entries.size();
+}
+
+bool Grade_cache::save(const string& path) const
+{
+    Profile_scope timer("save_cache");
+
+    Grade_cache_header h;
+    memcpy(h.magic, grade_cache_magic, 4);
+    h.version = grade_cache_version;
+    h.count = used.size();
+    h.probe = probe_grade();
+
+    // the columns of the entries used, in the order they were used
+    vector<u64> k(used.size());
+    vector<double> g(used.size());
+    vector<unsigned char> v(used.size());
+    vector<unsigned> positions(used.size());
+    for (vector<Cache_entry>::size_type i = 0; i != used.size(); ++i) {
+        k[i] = used[i].key;
+        g[i] = used[i].grade;
+        v[i] = used[i].valid;
+        positions[i] = unsigned(i);
+    }
+
+    // the index, and where each bucket of it begins
+    sort(positions.begin(), positions.end(), [&k](unsigned x, unsigned y) { return k[x] < k[y]; });
+    vector<unsigned> b(bucket_count + 1);
+    vector<unsigned>::size_type i = 0;
+    for (unsigned t = 0; t != bucket_count; ++t) {
+        b[t] = unsigned(i);
+        while (i != positions.size() && (k[positions[i]] >> 48) == t)
+            ++i;
+    }
+    b[bucket_count] = unsigned(i);
+
+    // write the new cache beside the old one, then put it in its place.
+    string temp = path + ".tmp";
+    {
+        ofstream out(temp.c_str(), std::ios::binary);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        write_column(out, k);
+        write_column(out, g);
+        write_column(out, v);
+        write_column(out, positions);
+        write_column(out, b);
+        if (!out.flush()) {
+            out.close();
+            remove(temp.c_str());
+            return false;
+        }
+    }
+    return rename(temp.c_str(), path.c_str()) == 0;
+}
+
+// ================= Hashing and reading lines ===================
+
+u64 line_hash(const char* b, const char* e)
+{
+    // (8 bytes at a time, mixing each word in with a multiply and a shift, starting from the length)
+    u64 h = 14695981039346656037ULL ^ u64(e - b);
+    for (; e - b >= 8; b += 8) {
+        u64 w;
+        memcpy(&w, b, 8);
+        h = (h ^ w) * 1099511628211ULL;
+        h ^= h >> 29;
+    }
+    u64 w = 0;
+    memcpy(&w, b, e - b);
+    h = (h ^ w) * 1099511628211ULL;
+
+    // (the "splitmix64" finaliser, so that every bit of the line affects the top 16 bits)
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+// whether a character is white space (as reading a word with >> takes it)
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+// whether a word starting with this character would be read as a homework grade of the record before it
+static bool starts_number(char c)
+{
+    return (c >= '0' && c <= '9') || c == '+' || c == '-';
+}
+
+bool read_text_cached(const char* b, const char* e, vector<Student_info>& students, str_sz& maxlen,
+                      Grade_cache& cache)
+{
+    Profile_scope timer("read_text_cached");
+    const vector<Student_info>::size_type start = students.size();
+    str_sz longest = maxlen;
+    vector<Cache_entry> entries;
+    long long hits = 0;
+    size_t expected = 0;       // (where the next line is most likely to be in the cache)
+    Student_info record;
+
+    // (there is at most one record on each line, so the room for them can be made at once)
+    vector<Student_info>::size_type lines = count(b, e, '\n') + 1;
+    if (students.capacity() < start + lines)
+        students.reserve(max(start + lines, 2 * students.capacity()));
+    entries.reserve(lines);
+
+    for (const char* line = b; line != e; ) {
+        const char* end = static_cast<const char*>(memchr(line, '\n', e - line));
+        const char* next = end ? end + 1 : e;
+        if (!end)
+            end = e;
+
+        // the name is the first word of the line (and a line of only white space holds no record).
+        const char* name = line;
+        while (name != end && is_space(*name))
+            ++name;
+        if (name == end) {
+            line = next;
+            continue;
+        }
+        const char* name_end = name;
+        while (name_end != end && !is_space(*name_end))
+            ++name_end;
+
+        Cache_entry entry;
+        entry.key = line_hash(line, end);
+        if (cache.find(entry.key, entry, expected))
+            ++hits;
+        else {
+            // parse and grade the line, checking it is a whole record on its own.
+            istringstream in(string(line, end));
+            if (starts_number(*name) || !record.read(in) || !(in >> ws).eof()) {
+                students.erase(students.begin() + start, students.end());
+                return false;
+            }
+            entry.valid = record.valid();
+            entry.grade = entry.valid ? record.grade() : 0;
+        }
+
+        students.push_back(Student_info(string(name, name_end), entry.grade, entry.valid));
+        longest = max(longest, str_sz(name_end - name));
+        entries.push_back(entry);
+        line = next;
+    }
+
+    maxlen = longest;
+    cache.use(entries, hits);
+    profile_count("records read", entries.size());
+    profile_count("cache hits", hits);
+    return true;
+}
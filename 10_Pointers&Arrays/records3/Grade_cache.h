@@ -0,0 +1,114 @@
+#ifndef GUARD_Grade_cache_h
+#define GUARD_Grade_cache_h
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Student_info.h"
+
+/**
+ * =============
+ * GRADE CACHE
+ * =============
+ * When the same class files are graded again and again with only a few lines changed between runs,
+ * most of the work of a run (parsing and grading every record) has already been done by the last one.
+ * A grade cache keeps the result of every record line that has been graded (its final grade, and
+ * whether it is valid), under a 64-bit HASH of the line's bytes, in a small file kept between runs:
+ *
+ *  | header | keys | grades | valid flags | index | buckets |
+ *
+ *  header       - the magic bytes "SGC1", a version number, the number of entries, and the grade of a
+ *                 fixed "probe" record (so that a cache made by a program that grades differently is
+ *                 noticed, and thrown away, rather than used).
+ *  keys         - the hash of each line (a 64-bit integer), in the order the lines were read.
+ *  grades       - the final grade of each line's record.
+ *  valid flags  - a single byte per line, non-zero if its record is valid (has homework).
+ *  index        - the position of every entry, in increasing order of their keys.
+ *  buckets      - (65536 + 1) positions in the index, with the keys whose top 16 bits are t in
+ *                 [buckets[t], buckets[t+1]).
+ *
+ * Reading a line that is in the cache then only takes hashing it, finding its key, and taking the name off
+ * the front of the line; only new or changed lines are parsed and graded. As the lines of a file that has
+ * not changed come in the same order as last time, the entry after the one last found is checked first,
+ * so most keys are found without searching (or missing the processor's cache); any other key is looked up
+ * in the index (a binary search, narrowed down by its bucket). The file written at the end of a run holds
+ * the lines read in that run, so lines that have gone from the class files do not pile up in it.
+ *
+ * A line's record only depends on the line itself if it is a whole record on its own, which is how class
+ * files are written (one record per line). As a record is read as a sequence of words, a line that is not
+ * (such as a record split over two lines, or a name starting with a digit, which the homework of the
+ * record before it would be read from) makes the whole file be read without the cache instead, so the
+ * records read are always exactly those of reading the file in the usual way.
+ **/
+
+// the result of grading a single line, under the hash of the line
+struct Cache_entry {
+    unsigned long long key;
+    double grade;
+    bool valid;
+};
+
+class Grade_cache {
+public:
+    Grade_cache();
+
+    /**
+     * Loads a cache file, returning false (and leaving the cache empty) if there is no such file, or it
+     * is not a cache file of this version, or it was made by a program that grades differently, or it is
+     * damaged (its size does not match the number of entries, or its index points outside them).
+     **/
+    bool load(const std::string&);
+
+    /**
+     * Writes every entry used (found or added) since the cache was loaded to a file, in the order they
+     * were used (by way of a temporary file, so that the old cache is only replaced once the new one
+     * is complete).
+     **/
+    bool save(const std::string&) const;
+
+    /**
+     * Finds the entry of the line with the given hash in the cache loaded, returning false if there is
+     * none. 'next' is where to look first (the position after the entry last found, which is where it
+     * is left).
+     **/
+    bool find(unsigned long long key, Cache_entry&, std::size_t& next) const;
+
+    // notes the entries of a file (or part of one) read, found in the cache or not (safe to call from any thread)
+    void use(const std::vector<Cache_entry>&, long long hits);
+
+    // the number of lines found in the cache, and read in all, since it was loaded
+    long long hits() const { return hit_count; }
+    long long lines() const { return line_count; }
+
+private:
+    // the columns of the entries loaded, in the order they were read, and the index of them by key
+    std::vector<unsigned long long> keys;
+    std::vector<double> grades;
+    std::vector<unsigned char> valid;
+    std::vector<unsigned> index, buckets;
+
+    // the entries used in this run
+    std::vector<Cache_entry> used;
+    long long hit_count, line_count;
+    std::mutex use_lock;
+
+    // (a cache may be in use by several threads, so it is never copied)
+    Grade_cache(const Grade_cache&);
+    Grade_cache& operator=(const Grade_cache&);
+};
+
+// the hash of the bytes [b, e) of a line (the same from run to run, on machines of the same byte order)
+unsigned long long line_hash(const char* b, const char* e);
+
+/**
+ * Reads the records of a text roster held in [b, e), one per line, taking the grades of the lines in the
+ * cache from it, adding them to the end of the vector and updating the length of the longest name.
+ * Returns false (adding nothing) if some line is not a whole record on its own, in which case the text
+ * should be read the usual way instead.
+ **/
+bool read_text_cached(const char* b, const char* e, std::vector<Student_info>&, std::string::size_type&,
+                      Grade_cache&);
+
+#endif
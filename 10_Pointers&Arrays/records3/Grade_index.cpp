@@ -0,0 +1,73 @@
+#include <algorithm>
+using std::lower_bound;
+using std::sort;
+
+#include <cstddef>
+using std::size_t;
+
+#include <limits>
+using std::numeric_limits;
+
+#include <utility>
+using std::pair;
+
+#include <vector>
+using std::vector;
+
+#include "Grade_index.h"
+#include "Student_info.h"
+
+
+Grade_index::Grade_index(roster_iter b, roster_iter e)
+{
+    const size_t n = e - b;
+
+    // sort (grade, position) pairs: by grade, and then by position for records of the same grade.
+    vector<pair<double, size_t> > keys(n);
+    for (size_t i = 0; i != n; ++i) {
+        keys[i].first = b[i].valid() ? b[i].grade() : -numeric_limits<double>::infinity();
+        keys[i].second = i;
+    }
+    sort(keys.begin(), keys.end());
+
+    positions.resize(n);
+    grades.resize(n);
+    for (size_t i = 0; i != n; ++i) {
+        grades[i] = keys[i].first;
+        positions[i] = keys[i].second;
+    }
+}
+
+Grade_index::const_iterator Grade_index::first_at_least(double g) const
+{
+    return positions.begin() + (lower_bound(grades.begin(), grades.end(), g) - grades.begin());
+}
+
+Grade_index::View Grade_index::ungraded() const
+{
+    // (every grade is above -infinity, so this finds the first record with a grade)
+    return View(positions.begin(), first_at_least(-numeric_limits<double>::max()));
+}
+
+Grade_index::View Grade_index::between(double lo, double hi) const
+{
+    // (the ungraded records are never in a range, even one starting at -infinity)
+    const_iterator b = first_at_least(lo), e = first_at_least(hi), graded = ungraded().end();
+    if (b < graded)
+        b = graded;
+    return View(b, e < b ? b : e);
+}
+
+Grade_index::View Grade_index::fails(double pass_mark) const
+{
+    // (the ungraded records always fail, whatever the pass mark)
+    const_iterator e = first_at_least(pass_mark), graded = ungraded().end();
+    return View(positions.begin(), e < graded ? graded : e);
+}
+
+Grade_index::View Grade_index::passes(double pass_mark) const
+{
+    // (with a pass mark of -infinity, only the ungraded records would be below it, and they still fail)
+    const_iterator b = first_at_least(pass_mark), graded = ungraded().end();
+    return View(b < graded ? graded : b, positions.end());
+}
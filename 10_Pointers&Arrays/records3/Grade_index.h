@@ -0,0 +1,70 @@
+#ifndef GUARD_Grade_index_h
+#define GUARD_Grade_index_h
+
+#include <cstddef>
+#include <vector>
+
+#include "Student_info.h"
+
+/**
+ * ===============
+ * THE GRADE INDEX
+ * ===============
+ * extract_fails() finds the failing students by checking every record against fgrade() (and moving
+ * them to the front), so each new pass mark means looking at (and moving) every record again.
+ *
+ * A Grade_index instead keeps the positions of the records sorted by grade, lowest first, once:
+ *
+ *      positions:  [ ungraded records... | 31.6 | 60.2 | 71.0 | 72.6 | ... | 91.8 ]
+ *
+ * Records with no grade (not valid) are treated as having the lowest grade of all, so they come
+ * first, which is where fgrade() puts them too (they always fail). The records with grades in
+ * any range are then next to each other in the index, and the ends of the range are found by
+ * binary search on a copy of the grades. So for any pass mark, the failing records are all the
+ * positions before the first grade that reaches it, and the passing records are all those after:
+ * each is a View of the index, found in O(log n) time, and listed in O(k) for k records, without
+ * moving (or even looking at) any of the records themselves.
+ *
+ * Records of the same grade are in the order they appear in the roster.
+ **/
+class Grade_index {
+public:
+    typedef std::vector<std::size_t>::const_iterator const_iterator;
+    typedef std::vector<std::size_t>::size_type size_type;
+
+    // some of the records: their positions in the roster, in order of grade
+    class View {
+    public:
+        View(const_iterator b, const_iterator e): first(b), last(e) { }
+        const_iterator begin() const { return first; }
+        const_iterator end() const { return last; }
+        size_type size() const { return last - first; }
+        bool empty() const { return first == last; }
+    private:
+        const_iterator first, last;
+    };
+
+    // indexes a roster, which must not change (or move) while the index is used.
+    Grade_index(roster_iter b, roster_iter e);
+
+    // the number of records indexed
+    size_type size() const { return positions.size(); }
+
+    // the records with no grade
+    View ungraded() const;
+    // the records with a grade in [lo, hi)
+    View between(double lo, double hi) const;
+
+    // the records that fail (as fgrade() does, with the given pass mark instead of 60), and those that pass.
+    View fails(double pass_mark) const;
+    View passes(double pass_mark) const;
+
+private:
+    std::vector<std::size_t> positions;     // the positions of the records, in order of grade
+    std::vector<double> grades;             // their grades, in the same order (-infinity if ungraded)
+
+    // the first record in the index with a grade of at least g
+    const_iterator first_at_least(double g) const;
+};
+
+#endif
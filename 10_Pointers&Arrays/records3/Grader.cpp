@@ -0,0 +1,33 @@
+#include <cstddef>
+using std::size_t;
+
+#include <string>
+using std::string;
+
+#include "Grader.h"
+
+/**
+ * The grading schemes that can be chosen by name. Each entry is a separate instantiation of Grader,
+ * so the policies of each are still inlined into its function; only the call through the table is indirect.
+ **/
+const Grading_scheme grading_schemes[] = {
+    // the "standard grading scheme": the median homework grade, no homework is an error
+    { "standard", grade_with<Standard_grader> },
+    // the "average grading scheme": the average homework grade instead
+    { "average", grade_with<Grader<Standard_weights, Average_homework, Reject_missing> > },
+    // the "optimistic" scheme: the median of the homework turned in, with none counting as 0
+    { "optimistic", grade_with<Grader<Standard_weights, Turned_in_homework, Zero_missing> > },
+    // the standard scheme with more weight on the exams
+    { "exams", grade_with<Grader<Exam_weights, Median_homework, Reject_missing> > }
+};
+
+const size_t grading_scheme_count = sizeof(grading_schemes) / sizeof(grading_schemes[0]);
+
+const Grading_scheme* find_grading_scheme(const string& name)
+{
+    for (size_t i = 0; i != grading_scheme_count; ++i) {
+        if (name == grading_schemes[i].name)
+            return &grading_schemes[i];
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+#ifndef GUARD_Grader_h
+#define GUARD_Grader_h
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "average.h"
+#include "median.h"
+
+/**
+ * ====================
+ * GRADING POLICIES
+ * ====================
+ * A grading scheme is made up of three choices:
+ *  - the weights given to the midterm, the final exam and the homework,
+ *  - how the homework grades are combined into one (the median, the average, ...),
+ *  - what to do for a student with no homework at all.
+ *
+ * Rather than passing these in as function pointers (which the compiler can't see through, so each
+ * call is a jump to an unknown function), each choice is a small "policy" class, and a Grader is put
+ * together from one of each as template arguments:
+ *
+ *      Grader<Standard_weights, Median_homework, Reject_missing>
+ *
+ * The compiler then knows exactly which functions are called and which weights are used, so the whole
+ * grading step can be inlined (and, in loops over many students, vectorised).
+ *
+ * For choosing a scheme while the program runs, see grading_schemes[] below.
+ **/
+
+// ------------------------------ Weights policies ------------------------------
+// (each gives the weights of the midterm, final exam and homework, adding up to 1)
+
+// the usual weights: 20% midterm, 40% final exam, 40% homework
+struct Standard_weights {
+    static constexpr double midterm = 0.2, final = 0.4, homework = 0.4;
+};
+
+// weights putting more on the exams: 30% midterm, 50% final exam, 20% homework
+struct Exam_weights {
+    static constexpr double midterm = 0.3, final = 0.5, homework = 0.2;
+};
+
+// --------------------------- Homework aggregator policies ---------------------------
+// (each combines a non-empty range of homework grades [b, e) into a single homework grade)
+
+// the median of the homework grades
+struct Median_homework {
+    template<class In> static double combine(In b, In e) { return median<int>(b, e); }
+};
+
+// the average of the homework grades
+struct Average_homework {
+    template<class In> static double combine(In b, In e) { return average<int>(b, e); }
+};
+
+// the median of the homework grades that were turned in (non-zero), or 0 if none were.
+struct Turned_in_homework {
+    template<class In> static double combine(In b, In e) {
+        static thread_local Order_stats<int> stats;
+        static thread_local std::vector<int> turned_in;
+        turned_in.clear();
+        for (; b != e; ++b) {
+            if (*b != 0)
+                turned_in.push_back(*b);
+        }
+        return turned_in.empty() ? 0 : stats.median(turned_in.begin(), turned_in.end());
+    }
+};
+
+// --------------------------- Missing homework policies ---------------------------
+// (each gives the homework grade to use for a student with no homework at all)
+
+// a student without homework cannot be graded (as in grade(), a domain_error is thrown).
+struct Reject_missing {
+    static double homework() { throw std::domain_error("student has done no homework"); }
+};
+
+// a student without homework is graded as if they scored 0 for it.
+struct Zero_missing {
+    static double homework() { return 0; }
+};
+
+// ------------------------------ The Grader itself ------------------------------
+
+template<class Weights, class Homework, class Missing>
+struct Grader {
+    // the overall grade, given the midterm and final exam grades and the (combined) homework grade.
+    static double grade(int midterm, int final, double homework) {
+        return Weights::midterm * midterm + Weights::final * final + Weights::homework * homework;
+    }
+
+    // the overall grade, given the midterm and final exam grades and a range of homework grades [b, e).
+    template<class In> static double grade(int midterm, int final, In b, In e) {
+        return grade(midterm, final, b == e ? Missing::homework() : Homework::combine(b, e));
+    }
+
+    // out[i] = grade(mid[i], fin[i], hw[i]) for every i in [0, n)
+    // (with the weights known at compile time, the compiler is free to vectorise this loop)
+    static void grade_all(const int* mid, const int* fin, const double* hw, double* out, std::size_t n) {
+        for (std::size_t i = 0; i != n; ++i)
+            out[i] = grade(mid[i], fin[i], hw[i]);
+    }
+};
+
+// the grader used for every student record: the "standard grading scheme".
+typedef Grader<Standard_weights, Median_homework, Reject_missing> Standard_grader;
+
+/**
+ * ===========================
+ * CHOOSING A SCHEME AT RUN TIME
+ * ===========================
+ * Each Grader is a different type, so the choice between them has to be made when compiling. To choose
+ * one while the program is running (e.g. from its name), each is given a plain function of the same type
+ * that calls it, and these are gathered into a table. Only the choice of table entry is made at run time:
+ * each function itself is still fully inlined.
+ **/
+
+// grades a student from their midterm and final exam grades and the homework grades in [b, e)
+typedef double (*Grade_function)(int, int, const int*, const int*);
+
+// the Grade_function for a given Grader type
+template<class G> double grade_with(int midterm, int final, const int* b, const int* e)
+{
+    return G::grade(midterm, final, b, e);
+}
+
+struct Grading_scheme {
+    const char* name;
+    Grade_function grade;
+};
+
+// every grading scheme that can be chosen by name, and the number of them.
+extern const Grading_scheme grading_schemes[];
+extern const std::size_t grading_scheme_count;
+
+// the grading scheme with the given name, or a null pointer if there is none.
+const Grading_scheme* find_grading_scheme(const std::string&);
+
+#endif
@@ -0,0 +1,370 @@
+#include <algorithm>
+using std::max;
+using std::merge;
+using std::sort;
+
+#include <atomic>
+using std::atomic;
+
+#include <cctype>
+using std::isdigit;
+using std::isspace;
+
+#include <fstream>
+using std::ifstream;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+using std::istream;
+
+#include <iterator>
+using std::back_inserter;
+using std::make_move_iterator;
+
+#include <sstream>
+using std::istringstream;
+
+#include <string>
+using std::string;
+
+#include <thread>
+using std::thread;
+
+#include <vector>
+using std::vector;
+
+#include "Grade_cache.h"
+#include "Ingest.h"
+#include "Profile.h"
+#include "Roster_bin.h"
+#include "Student_info.h"
+
+typedef string::size_type str_sz;
+
+
+bool read_input(istream& in, vector<Student_info>& students, str_sz& maxlen)
+{
+    Profile_scope timer("read_input");
+    Student_info record;
+    long long n = 0;
+
+    // (skipping the white space before each record first, as reading its name would, to tell the end
+    //  of the input apart from a record that could not be read)
+    bool complete = true;
+    while (!(in >> std::ws).eof()) {
+        if (!record.read(in)) {
+            complete = false;
+            break;
+        }
+        maxlen = max(maxlen, record.name().size());
+        students.push_back(record);
+        ++n;
+    }
+    profile_count("records read", n);
+    return complete;
+}
+
+/**
+ * Reads the text of a roster through the grade cache, or the usual way if some line of it is not a whole
+ * record on its own (see read_text_cached()).
+ **/
+bool read_text(const string& text, vector<Student_info>& students, str_sz& maxlen, Grade_cache& cache)
+{
+    if (read_text_cached(text.data(), text.data() + text.size(), students, maxlen, cache))
+        return true;
+    istringstream in(text);
+    return read_input(in, students, maxlen);
+}
+
+bool read_file(istream& in, vector<Student_info>& students, str_sz& maxlen, Grade_cache* cache)
+{
+    if (is_roster_bin(in))
+        return read_roster_bin(in, students, maxlen);
+    else if (cache) {
+        // (the whole file is needed at once, to look up its lines)
+        string text;
+        char block[1 << 16];
+        while (in.read(block, sizeof(block)) || in.gcount() != 0)
+            text.append(block, in.gcount());
+        read_text(text, students, maxlen, *cache);
+    }
+    else
+        read_input(in, students, maxlen);
+    return true;
+}
+
+// ================= Duplicate detection ===================
+
+// collect the names of a sequence of records, sorted alphabetically
+void sorted_names(const vector<Student_info>& students, vector<string>& names)
+{
+    names.clear();
+    names.reserve(students.size());
+    for (vector<Student_info>::const_iterator it = students.begin(); it != students.end(); ++it)
+        names.push_back(it->name());
+    sort(names.begin(), names.end());
+}
+
+// list (once each) the names that appear more than once in a sorted sequence of names
+void find_duplicates(const vector<string>& names, vector<string>& dups)
+{
+    for (vector<string>::size_type i = 1; i < names.size(); ++i) {
+        // only note the first repeat of each name.
+        if (names[i] == names[i - 1] && (dups.empty() || dups.back() != names[i]))
+            dups.push_back(names[i]);
+    }
+}
+
+/**
+ * Reduces the sorted names of every batch to a single sorted sequence, by repeatedly merging
+ * neighbouring pairs of sequences until only one remains (so each name is only moved
+ * log2(number of batches) times).
+ **/
+void merge_names(vector<vector<string> >& lists)
+{
+    while (lists.size() > 1) {
+        vector<vector<string> > merged((lists.size() + 1) / 2);
+        for (vector<vector<string> >::size_type i = 0; i < lists.size(); i += 2) {
+            if (i + 1 == lists.size()) {
+                merged[i / 2].swap(lists[i]);
+                continue;
+            }
+            vector<string>& out = merged[i / 2];
+            out.reserve(lists[i].size() + lists[i + 1].size());
+            merge(make_move_iterator(lists[i].begin()), make_move_iterator(lists[i].end()),
+                  make_move_iterator(lists[i + 1].begin()), make_move_iterator(lists[i + 1].end()),
+                  back_inserter(out));
+        }
+        lists.swap(merged);
+    }
+}
+
+// ================= Serial ingestion ===================
+
+void read_files(const vector<string>& files, Ingest_result& result, Grade_cache* cache)
+{
+    Profile_scope timer("read_files");
+    for (vector<string>::const_iterator f = files.begin(); f != files.end(); ++f) {
+        // Open the input file (in binary mode, in case it is a binary roster)
+        ifstream in_file(f->c_str(), std::ios::binary);
+        // If it was successfully opened, read it (counting a binary roster that can't be read as a failure).
+        if (in_file) {
+            if (read_file(in_file, result.students, result.maxlen, cache))
+                ++result.success_count;
+            else {
+                cout << "Could not read \'" << *f << "\' (the binary roster is truncated or corrupt)." << endl;
+                ++result.fail_count;
+            }
+        }
+        // If not, give an appropriate message.
+        else {
+            cout << "Could not open \'" << *f << "\'." << endl;
+            ++result.fail_count;
+        }
+    }
+    // (duplicate names are only looked for by read_files_parallel(), see Ingest.h)
+}
+
+// ================= Parallel ingestion ===================
+
+/**
+ * A single unit of work for a worker thread: either an entire file, or the lines of a text
+ * file that start within the byte range [begin, end).
+ **/
+struct Ingest_task {
+    string path;
+    bool whole;
+    std::streamoff begin, end;
+};
+
+/**
+ * The local batch produced by a single task, holding everything that later needs to be
+ * reduced into the Ingest_result.
+ **/
+struct Ingest_batch {
+    vector<Student_info> students;
+    str_sz maxlen;
+    vector<string> names;   // sorted
+    bool ok;                // (false if the task's file is a binary roster that could not be read)
+    bool complete;          // (false if a record of the task could not be read, so reading stopped there)
+
+    Ingest_batch(): maxlen(0), ok(true), complete(true) {}
+};
+
+/**
+ * Moves a stream to the start of the first line beginning at or after the given position,
+ * returning that position (or the size of the file if there is no such line).
+ **/
+std::streamoff line_start(istream& in, std::streamoff pos, std::streamoff size)
+{
+    if (pos <= 0)
+        return 0;
+    if (pos >= size)
+        return size;
+
+    // read from the character before pos up to the end of its line.
+    string discard;
+    in.seekg(pos - 1);
+    getline(in, discard);
+
+    if (!in || in.eof()) {
+        in.clear();
+        return size;
+    }
+    return in.tellg();
+}
+
+/**
+ * Moves a stream to the start of the first line beginning at or after the given position whose first
+ * character starts a name, returning that position (or the size of the file if there is no such line).
+ *
+ * A record may go on over several lines (its homework grades are read until a word that is not a
+ * number), so not every line starts a record. But a word that cannot start a number is never read as a
+ * grade: either it is the name of the next record, or the record before it is missing a grade, in which
+ * case reading stops there (as it would reading the whole file). So it is always safe to split the file
+ * in front of it. (Lines starting with white space or a digit or sign are simply passed over.)
+ **/
+std::streamoff record_start(istream& in, std::streamoff pos, std::streamoff size)
+{
+    for (;;) {
+        pos = line_start(in, pos, size);
+        if (pos == size)
+            return size;
+
+        in.seekg(pos);
+        int c = in.peek();
+        if (c != EOF && !isspace(c) && !isdigit(c) && c != '+' && c != '-')
+            return pos;
+        in.clear();
+        ++pos;
+    }
+}
+
+// carry out a single task, parsing its records into its own batch (or finding them in the cache, if given).
+void run_task(const Ingest_task& task, Ingest_batch& batch, Grade_cache* cache)
+{
+    Profile_scope timer("ingest_task");
+    ifstream in(task.path.c_str(), std::ios::binary);
+
+    if (task.whole) {
+        batch.ok = read_file(in, batch.students, batch.maxlen, cache);
+    }
+    else {
+        in.seekg(0, istream::end);
+        std::streamoff size = in.tellg();
+
+        // a task owns every record that starts inside its byte range.
+        std::streamoff b = record_start(in, task.begin, size);
+        std::streamoff e = record_start(in, task.end, size);
+
+        if (b < e) {
+            string buf(e - b, '\0');
+            in.seekg(b);
+            in.read(&buf[0], e - b);
+            buf.resize(in.gcount());
+
+            if (cache)
+                batch.complete = read_text(buf, batch.students, batch.maxlen, *cache);
+            else {
+                istringstream chunk(buf);
+                batch.complete = read_input(chunk, batch.students, batch.maxlen);
+            }
+        }
+    }
+
+    sorted_names(batch.students, batch.names);
+}
+
+void read_files_parallel(const vector<string>& files, Ingest_result& result, unsigned threads,
+                         str_sz chunk_bytes, Grade_cache* cache)
+{
+    Profile_scope timer("read_files_parallel");
+    if (threads == 0)
+        threads = max(1u, thread::hardware_concurrency());
+
+    // plan the tasks (in order), checking which files can be opened along the way.
+    vector<Ingest_task> tasks;
+    for (vector<string>::const_iterator f = files.begin(); f != files.end(); ++f) {
+        ifstream in_file(f->c_str(), std::ios::binary);
+        if (!in_file) {
+            cout << "Could not open \'" << *f << "\'." << endl;
+            ++result.fail_count;
+            continue;
+        }
+        ++result.success_count;
+
+        in_file.seekg(0, istream::end);
+        std::streamoff size = in_file.tellg();
+        in_file.seekg(0);
+
+        Ingest_task t;
+        t.path = *f;
+        t.whole = size <= std::streamoff(chunk_bytes) || is_roster_bin(in_file);
+        t.begin = 0;
+        t.end = size;
+
+        if (t.whole) {
+            tasks.push_back(t);
+        }
+        else {
+            for (std::streamoff b = 0; b < size; b += chunk_bytes) {
+                t.begin = b;
+                t.end = std::min(size, b + std::streamoff(chunk_bytes));
+                tasks.push_back(t);
+            }
+        }
+    }
+
+    // have the workers take the next task not yet started until none are left.
+    vector<Ingest_batch> batches(tasks.size());
+    atomic<size_t> next(0);
+
+    vector<thread> workers;
+    for (unsigned i = 0; i < threads && i < tasks.size(); ++i) {
+        workers.push_back(thread([&]() {
+            for (size_t t = next++; t < tasks.size(); t = next++)
+                run_task(tasks[t], batches[t], cache);
+        }));
+    }
+    for (vector<thread>::iterator w = workers.begin(); w != workers.end(); ++w)
+        w->join();
+
+    // reduce the batches, in the order of the tasks.
+    Profile_scope reduce_timer("reduce_batches");
+
+    // Once a record of a file could not be read, none after it are (as in reading the file serially),
+    // so the later tasks of the same file are dropped.
+    for (vector<Ingest_batch>::size_type i = 1; i < batches.size(); ++i) {
+        if (!tasks[i].whole && !tasks[i - 1].whole && tasks[i].path == tasks[i - 1].path &&
+            !batches[i - 1].complete) {
+            batches[i].students.clear();
+            batches[i].names.clear();
+            batches[i].maxlen = 0;
+            batches[i].complete = false;
+        }
+    }
+
+    size_t total = 0;
+    for (vector<Ingest_batch>::const_iterator b = batches.begin(); b != batches.end(); ++b)
+        total += b->students.size();
+    result.students.reserve(result.students.size() + total);
+
+    vector<vector<string> > names(batches.size());
+    for (vector<Ingest_batch>::size_type i = 0; i != batches.size(); ++i) {
+        if (!batches[i].ok) {
+            cout << "Could not read \'" << tasks[i].path << "\' (the binary roster is truncated or corrupt)." << endl;
+            --result.success_count;
+            ++result.fail_count;
+        }
+        result.maxlen = max(result.maxlen, batches[i].maxlen);
+        result.students.insert(result.students.end(),
+                               make_move_iterator(batches[i].students.begin()),
+                               make_move_iterator(batches[i].students.end()));
+        names[i].swap(batches[i].names);
+    }
+
+    merge_names(names);
+    if (!names.empty())
+        find_duplicates(names[0], result.duplicates);
+}
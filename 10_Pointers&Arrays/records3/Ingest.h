@@ -0,0 +1,76 @@
+#ifndef GUARD_Ingest_h
+#define GUARD_Ingest_h
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Grade_cache.h"
+#include "Student_info.h"
+
+/**
+ * Reads from an input stream student grade data and adds it to the end of a
+ * vector. It also takes a value (by reference) representing the size of the
+ * student name read so far, in order to updated and used for padding the output
+ * later. Returns false if reading stopped at a record that could not be read
+ * (rather than at the end of the input).
+ **/
+bool read_input(std::istream&, std::vector<Student_info>&, std::string::size_type&);
+
+/**
+ * Reads an input file of student records, which can either be a text roster or a binary
+ * roster (written by the --convert mode), adding them to the end of a vector.
+ * A text roster is read through the grade cache, if one is given (see Grade_cache.h).
+ * Returns false if the file is a binary roster that could not be read (truncated or corrupt).
+ **/
+bool read_file(std::istream&, std::vector<Student_info>&, std::string::size_type&, Grade_cache* = 0);
+
+/**
+ * Represents everything read from a set of input files: the records themselves (in the order
+ * of the files, and of the lines within them), along with what is needed by the rest of the
+ * program.
+ **/
+struct Ingest_result {
+    std::vector<Student_info> students;
+    // the length of the longest name, for padding the output
+    std::string::size_type maxlen;
+    // the number of files that could and could not be opened
+    int success_count, fail_count;
+    // every name that appears more than once (each listed once, in alphabetical order), found
+    // only by read_files_parallel(), where the work of finding them is shared between the threads
+    std::vector<std::string> duplicates;
+
+    Ingest_result(): maxlen(0), success_count(0), fail_count(0) {}
+};
+
+/**
+ * Reads every given input file, one after the other, into a single Ingest_result
+ * (through the grade cache, if one is given). Duplicate names are not looked for, so that
+ * the usual serial run does no more work than reading the records.
+ **/
+void read_files(const std::vector<std::string>&, Ingest_result&, Grade_cache* = 0);
+
+/**
+ * ==================
+ * PARALLEL INGESTION
+ * ==================
+ * Does the same as read_files(), but splits the work into separate "tasks" that are carried
+ * out by a number of worker threads at the same time:
+ *  - every input file is a task of its own,
+ *  - text files larger than a given number of bytes are loaded into memory and split further
+ *    into tasks of roughly that size, only in front of a line whose first word is certain to
+ *    start a record (see record_start() in Ingest.cpp), as a record may go on over several lines.
+ *
+ * Each task parses its records into its own local batch, so that the workers never need to
+ * share (or lock) anything while parsing. The batches are then merged in the order of the
+ * tasks. Since a file is only split between records, and the tasks after one that stopped at a
+ * record that could not be read are dropped (as reading the file serially stops there), the
+ * result is exactly the same as read_files() gives, whatever the number of threads used.
+ *
+ * A thread count of 0 uses as many threads as the machine has cores. Every task reads its text
+ * through the grade cache, if one is given.
+ **/
+void read_files_parallel(const std::vector<std::string>&, Ingest_result&, unsigned threads,
+                         std::string::size_type chunk_bytes = 8 << 20, Grade_cache* = 0);
+
+#endif
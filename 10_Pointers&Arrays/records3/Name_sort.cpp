@@ -0,0 +1,156 @@
+#include <algorithm>
+using std::copy;
+using std::sort;
+
+#include <cstddef>
+using std::size_t;
+
+#include <string>
+using std::string;
+
+#include <utility>
+using std::move;
+
+#include <vector>
+using std::vector;
+
+#include "Name_sort.h"
+#include "Student_info.h"
+
+
+typedef unsigned long long u64;
+
+// the sort key of one record: the first 8 bytes of its name, and its position.
+struct Name_key {
+    u64 prefix;
+    size_t index;
+};
+
+// buckets with fewer keys than this are sorted by comparing names instead.
+static const size_t small_bucket = 32;
+
+/**
+ * Packs 8 bytes of a name, starting at the given offset, into an integer, the first byte being the most
+ * significant, and any bytes past the end of the name being 0. Comparing two prefixes as integers then
+ * gives the same order as comparing those bytes of the names (as unsigned chars, which is how std::string
+ * compares them).
+ **/
+static u64 name_prefix(const string& name, string::size_type offset = 0)
+{
+    u64 prefix = 0;
+    string::size_type n = name.size() < offset + 8 ? name.size() : offset + 8;
+    for (string::size_type i = offset; i < n; ++i)
+        prefix |= u64((unsigned char) name[i]) << (56 - 8 * (i - offset));
+    return prefix;
+}
+
+// orders keys as sort() with compare would, with records of the same name in their original order.
+class Key_less {
+public:
+    Key_less(vector<Student_info>::const_iterator s): students(s) { }
+    bool operator()(const Name_key& x, const Name_key& y) const {
+        if (x.prefix != y.prefix)
+            return x.prefix < y.prefix;
+        // (the prefixes only tell us about the first 8 bytes: the rest of the names decide)
+        int c = students[x.index].name().compare(students[y.index].name());
+        return c != 0 ? c < 0 : x.index < y.index;
+    }
+private:
+    vector<Student_info>::const_iterator students;
+};
+
+/**
+ * Sorts the keys [b, e), whose names are known to share their first 'offset' + 'byte' bytes (their
+ * prefixes holding bytes 'offset' to 'offset' + 7), by splitting them into buckets by the next byte
+ * (using tmp, of the same size, to scatter them into), and then sorting each bucket in turn.
+ **/
+static void radix_sort(Name_key* b, Name_key* e, Name_key* tmp, int byte, string::size_type offset,
+                       vector<Student_info>::const_iterator students, const Key_less& less)
+{
+    size_t n = e - b;
+    if (n < small_bucket) {
+        sort(b, e, less);
+        return;
+    }
+
+    // Once the prefixes are used up, move on to the next 8 bytes of the names, if any name has them.
+    if (byte == 8) {
+        offset += 8;
+        bool longer = false;
+        for (Name_key* k = b; k != e; ++k) {
+            const string& name = students[k->index].name();
+            k->prefix = name_prefix(name, offset);
+            longer = longer || name.size() > offset;
+        }
+        // (if not, the names are all the same, so they are only sorted by their positions)
+        if (!longer) {
+            sort(b, e, less);
+            return;
+        }
+        byte = 0;
+    }
+
+    // count the keys in each bucket, and skip this byte altogether if they are all in the same one.
+    const int shift = 56 - 8 * byte;
+    size_t count[256] = { 0 };
+    for (Name_key* k = b; k != e; ++k)
+        ++count[(k->prefix >> shift) & 0xff];
+    if (count[(b->prefix >> shift) & 0xff] == n) {
+        radix_sort(b, e, tmp, byte + 1, offset, students, less);
+        return;
+    }
+
+    // where each bucket starts, then scatter the keys into their buckets (in order, so equal keys stay in order)
+    size_t start[256], next = 0;
+    for (int d = 0; d != 256; ++d) {
+        start[d] = next;
+        next += count[d];
+    }
+    size_t pos[256];
+    copy(start, start + 256, pos);
+    for (Name_key* k = b; k != e; ++k)
+        tmp[pos[(k->prefix >> shift) & 0xff]++] = *k;
+    copy(tmp, tmp + n, b);
+
+    for (int d = 0; d != 256; ++d) {
+        if (count[d] > 1)
+            radix_sort(b + start[d], b + start[d] + count[d], tmp + start[d], byte + 1, offset, students, less);
+    }
+}
+
+void name_order(vector<Student_info>::const_iterator b, vector<Student_info>::const_iterator e, vector<size_t>& order)
+{
+    // 1) extract the keys, once
+    vector<Name_key> keys(e - b), tmp(e - b);
+    for (vector<Name_key>::size_type i = 0; i != keys.size(); ++i) {
+        keys[i].prefix = name_prefix(b[i].name());
+        keys[i].index = i;
+    }
+
+    // 2) sort them
+    if (!keys.empty())
+        radix_sort(&keys[0], &keys[0] + keys.size(), &tmp[0], 0, 0, b, Key_less(b));
+
+    order.resize(keys.size());
+    for (vector<Name_key>::size_type i = 0; i != keys.size(); ++i)
+        order[i] = keys[i].index;
+}
+
+void name_order(const vector<Student_info>& students, vector<size_t>& order)
+{
+    name_order(students.begin(), students.end(), order);
+}
+
+void sort_by_name(vector<Student_info>& students)
+{
+    Profile_scope timer("sort_by_name");
+    vector<size_t> order;
+    name_order(students, order);
+
+    // 3) move every record into its place in a new vector, then swap it in
+    vector<Student_info> sorted;
+    sorted.reserve(students.size());
+    for (vector<size_t>::size_type i = 0; i != order.size(); ++i)
+        sorted.push_back(move(students[order[i]]));
+    students.swap(sorted);
+}
@@ -0,0 +1,36 @@
+#ifndef GUARD_Name_sort_h
+#define GUARD_Name_sort_h
+
+#include <cstddef>
+#include <vector>
+
+#include "Student_info.h"
+
+/**
+ * ===================
+ * SORTING BY NAME
+ * ===================
+ * sort(students.begin(), students.end(), compare) compares whole names again and again, and moves
+ * whole records (names and all) around while it sorts.
+ *
+ * sort_by_name() instead:
+ *  1) extracts a small "key" for each record once: the first 8 bytes of its name, packed into a single
+ *     integer (so that comparing integers compares those bytes in alphabetical order), and its position,
+ *  2) sorts the keys with an MSD ("most significant digit first") radix sort: the keys are split into
+ *     256 "buckets" by their first byte, each bucket by the second byte, and so on. A bucket whose names
+ *     share all 8 bytes has its keys re-extracted from the next 8 bytes of the names, and carries on.
+ *     Small buckets are finished off by comparing the names (and positions, for equal names).
+ *  3) moves each record into its place, once, using the sorted positions (a "permutation").
+ *
+ * The order is the same as sort() with compare, except that records with the same name stay in the
+ * order they were in (i.e. the sort is stable).
+ **/
+void sort_by_name(std::vector<Student_info>&);
+
+// the positions of the records in name order (step 1 and 2 above), without moving any of them.
+void name_order(const std::vector<Student_info>&, std::vector<std::size_t>&);
+// (the same, for the records in [b, e), giving their positions counting from b)
+void name_order(std::vector<Student_info>::const_iterator, std::vector<Student_info>::const_iterator,
+                std::vector<std::size_t>&);
+
+#endif
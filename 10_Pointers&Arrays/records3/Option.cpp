@@ -1,5 +1,18 @@
 #include <algorithm>
 using std::max;
+using std::sort;
+
+#include <charconv>
+using std::chars_format;
+using std::to_chars;
+
+#include <cmath>
+
+#include <cstddef>
+using std::size_t;
+
+#include <cstdio>
+using std::snprintf;
 
 #include <ios>
 using std::fixed;
@@ -19,14 +32,21 @@ using std::ostream;
 #include <map>
 using std::map;
 
+#include <sstream>
+using std::istringstream;
+
 #include <string>
 using std::string;
 
 #include <vector>
 using std::vector;
 
+#include "Grade_index.h"
 #include "Option.h"
+#include "Profile.h"
+#include "Rank_index.h"
 #include "Student_info.h"
+#include "Student_table.h"
 #include "pad_str.h"
 #include "trim.h"
 
@@ -80,60 +100,179 @@ Option input_option(const Option_map& opts, const string& prompt="")
     return opt_input->second;   
 }
 
-/**
- * (The overarching student record outputting function)
- * Writes to an output file a sequence of student records (name, numerical grade, and letter grade if lg=true)
- * bounded by the iterators [b, e), with a padding factor used to improve readibility of output.
- **/
-void output_records(ostream& out, v_iter b, v_iter e, str_sz maxlen, bool lg=true)
-{   
-    // define labels for the output
-    string label1 = "STUDENT NAME     "; // allow extra space between labels
-    string label2 = "GRADE    ";
-    string label3 = "LETTER GRADE";
+// the labels of the columns of the output, with extra space between them
+static const string label1 = "STUDENT NAME     ";
+static const string label2 = "GRADE    ";
+static const string label3 = "LETTER GRADE";
 
-    // update the padding factor to consider the first label
-    maxlen = max(maxlen, label1.size());
+str_sz report_name_width(str_sz maxlen)
+{
+    // the padding factor must also consider the first label
+    return max(maxlen, label1.size());
+}
 
+string write_report_header(ostream& out, str_sz maxlen)
+{
     // do formatting for the labels of the output.
+    maxlen = report_name_width(maxlen);
     string header_line = label1 + pad_str(label1, maxlen) + label2 + " " + label3;
     string border(header_line.size(), '=');
     out << border << endl;
     out << header_line << endl;
     out << border << endl;
 
+    return border;
+}
+
+void write_report_row(ostream& out, const Student_info& s, str_sz maxlen, bool lg)
+{
     // create padding space after the grades for the letter grades 
-    string letter_pad = pad_str("00.0", label2.size());
+    static const string letter_pad = pad_str("00.0", label2.size());
 
-    while (b != e) {
-        // write the name, padded on the right for neater output
-        out << b->name()
-             << pad_str(b->name(), maxlen);
-
-        // compute and write the grade if record is valid.
-        if (b->valid()) {
-            double final_grade  = b->grade();
-            string letter_grade = b->letter_grade();
-
-            // Using fixed-point notation (00.0) write the grade.
-            streamsize prec = out.precision();
-            out << fixed << setprecision(1) << final_grade
-                 << setprecision(prec) 
-                 << defaultfloat;
-            if (lg) {
-                out << letter_pad << letter_grade;
-            }
-            out << endl;
-            
+    // write the name, padded on the right for neater output
+    out << s.name()
+         << pad_str(s.name(), report_name_width(maxlen));
+
+    // compute and write the grade if record is valid.
+    if (s.valid()) {
+        double final_grade  = s.grade();
+        const char* letter_grade = s.letter_grade();
+
+        // Using fixed-point notation (00.0) write the grade.
+        streamsize prec = out.precision();
+        out << fixed << setprecision(1) << final_grade
+             << setprecision(prec) 
+             << defaultfloat;
+        if (lg) {
+            out << letter_pad << letter_grade;
         }
-        // if record not valid (no homework), note this.
-        else {
-            out << "(no h/w)" << endl;
+        out << endl;
+        
+    }
+    // if record not valid (no homework), note this.
+    else {
+        out << "(no h/w)" << endl;
+    }
+}
+
+/**
+ * Writes x in fixed-point notation with one digit after the point, exactly as printf("%.1f") (and so
+ * an ostream using fixed << setprecision(1)) would, returning a pointer past the last character written.
+ *
+ * For any grade of a sensible size, x is rounded to a whole number of tenths q directly, and then q is
+ * checked (and corrected) against the exact halfway points (2q - 1)/20 and (2q + 1)/20 on either side
+ * of it, with std::fma, which works out x * 20 - (2q + 1) with no rounding in between, so its sign is exact.
+ * (Exact ties go to the even digit, as printf does.) Anything else is left to std::to_chars.
+ **/
+static char* write_fixed1(char* p, double x)
+{
+    if (!(x > -1e13 && x < 1e13))
+        return to_chars(p, p + 400, x, chars_format::fixed, 1).ptr;
+
+    if (std::signbit(x)) {
+        *p++ = '-';
+        x = -x;
+    }
+
+    long long q = (long long) (x * 10 + 0.5);
+    for (;;) {
+        double above = std::fma(x, 20.0, -double(2 * q + 1));
+        if (above > 0 || (above == 0 && q % 2 == 1)) {
+            ++q;
+            continue;
+        }
+        double below = std::fma(x, 20.0, -double(2 * q - 1));
+        if (below < 0 || (below == 0 && q % 2 == 1)) {
+            --q;
+            continue;
+        }
+        break;
+    }
+
+    // write the digits backwards into a small array, then copy them out
+    char digits[24];
+    char* d = digits + sizeof(digits);
+    *--d = char('0' + q % 10);
+    *--d = '.';
+    q /= 10;
+    do {
+        *--d = char('0' + q % 10);
+        q /= 10;
+    } while (q != 0);
+
+    return std::copy(d, digits + sizeof(digits), p);
+}
+
+Row_formatter::Row_formatter(ostream& os, str_sz maxlen, size_t cap):
+    out(os), width(report_name_width(maxlen)), capacity(cap), spaces(max(width, label2.size()) + 1, ' ')
+{
+    buf.reserve(capacity + 256);
+}
+
+void Row_formatter::row(const Student_info& s, bool lg)
+{
+    // the name, padded on the right (in the same way as pad_str() does) to the width of the column
+    const string& name = s.name();
+    buf += name;
+    buf.append(spaces, 0, name.size() > width ? 1 : width - name.size() + 1);
+
+    if (s.valid()) {
+        // the grade, in fixed-point notation with one digit after the point (as fixed << setprecision(1))
+        // (large enough for any double written out in full)
+        char digits[400];
+        buf.append(digits, write_fixed1(digits, s.grade()));
+
+        // the letter grade, lined up under its label (as pad_str("00.0", label2.size()))
+        if (lg) {
+            buf.append(spaces, 0, label2.size() - 4 + 1);
+            buf += s.letter_grade();
         }
+        buf += '\n';
+    }
+    else {
+        buf += "(no h/w)\n";
+    }
+
+    if (buf.size() >= capacity)
+        flush();
+}
+
+void Row_formatter::line(const string& text)
+{
+    buf += text;
+    buf += '\n';
+    if (buf.size() >= capacity)
+        flush();
+}
+
+void Row_formatter::flush()
+{
+    if (!buf.empty()) {
+        profile_count("bytes written", buf.size());
+        out.write(buf.data(), buf.size());
+        buf.clear();
+    }
+}
+
+/**
+ * (The overarching student record outputting function)
+ * Writes to an output file a sequence of student records (name, numerical grade, and letter grade if lg=true)
+ * bounded by the iterators [b, e), with a padding factor used to improve readibility of output.
+ **/
+void output_records(ostream& out, v_iter b, v_iter e, str_sz maxlen, bool lg=true)
+{   
+    Profile_scope timer("output_records");
+    string border = write_report_header(out, maxlen);
+
+    // the rows are rendered into a buffer, written out as it fills up (see Row_formatter)
+    Row_formatter rows(out, maxlen);
+    while (b != e) {
+        rows.row(*b, lg);
         ++b;
     }
     // add a 'footer' line
-    out << border << endl;
+    rows.line(border);
+    rows.flush();
 }
 
 // OPTION #1: Output all student records together
@@ -147,7 +286,8 @@ void output_records_passfail(ostream& out, v_iter b, v_iter e, str_sz maxlen)
 {   
     // Modify the sequence, 'extracting' the fails by moving them to
     //  the front. Retrive iterator pointing to the front of the 'pass' half.
-    v_iter c = extract_fails(b, e);
+    // (The fails are found two at a time with the fail_mask() kernel, see Student_table.h)
+    v_iter c = partition_fails(b, e);
 
     // Output both parts
     out << "\n--- STUDENTS WHO PASSED ---" << endl;
@@ -156,3 +296,214 @@ void output_records_passfail(ostream& out, v_iter b, v_iter e, str_sz maxlen)
     output_records(out, b, c, maxlen, false); // 'false' to not write letter grades (would be redundant here)
 
 }
+
+// ---------------------------------- Ranking options (see Rank_index.h) ----------------------------------
+
+// the number of students in the "TOP" option, and the percentiles given by the "PERCENTILES" option
+static const size_t top_count = 10;
+static const double cutoff_percentiles[] = { 90, 75, 50, 25, 10 };
+
+// the labels of the columns of a table of ranks
+static const string rank_label = "RANK     ";
+static const string percentile_label = "PERCENTILE";
+
+/**
+ * Writes a table of the records at the given positions of [b, e) (each with its rank and percentile),
+ * in the same layout as the other tables, with a column for the rank before the names:
+ *  ==============================================
+ *  RANK     STUDENT NAME     GRADE    PERCENTILE
+ *  ==============================================
+ *  1        Jane             93.2     95.0
+ **/
+static void write_rank_table(ostream& out, v_iter b, const Rank_index& index,
+                             const vector<size_t>& positions, str_sz maxlen)
+{
+    const str_sz width = report_name_width(maxlen);
+    string header_line = rank_label + label1 + pad_str(label1, width) + label2 + " " + percentile_label;
+    string border(header_line.size(), '=');
+    out << border << '\n' << header_line << '\n' << border << '\n';
+
+    // (the rows are built in a single buffer, written out as it fills up, as a Row_formatter does)
+    string buf, spaces(max(width, rank_label.size()) + 1, ' ');
+    for (vector<size_t>::const_iterator p = positions.begin(); p != positions.end(); ++p) {
+        const Student_info& s = b[*p];
+        char field[64];
+        int n = snprintf(field, sizeof(field), "%zu", index.rank(*p));
+        buf.append(field, n);
+        buf.append(spaces, 0, size_t(n) < rank_label.size() ? rank_label.size() - n : 1);
+
+        buf += s.name();
+        buf.append(spaces, 0, s.name().size() > width ? 1 : width - s.name().size() + 1);
+
+        n = snprintf(field, sizeof(field), "%-*.1f %.1f\n", int(label2.size()), s.grade(), index.percentile(*p));
+        buf.append(field, n);
+
+        if (buf.size() >= (1 << 16)) {
+            out << buf;
+            buf.clear();
+        }
+    }
+    out << buf << border << endl;
+}
+
+// OPTION #3: Output the top students only (found without sorting the whole roster).
+void output_records_top(ostream& out, v_iter b, v_iter e, str_sz maxlen)
+{
+    Profile_scope timer("output_records_top");
+    vector<size_t> positions;
+    top_k(b, e, top_count, positions);
+
+    // (there are only a few of them, so a copy of each is made, to write them as usual)
+    vector<Student_info> top;
+    for (vector<size_t>::const_iterator p = positions.begin(); p != positions.end(); ++p)
+        top.push_back(b[*p]);
+
+    out << "\n--- TOP " << top_count << " STUDENTS ---" << endl;
+    output_records(out, top.begin(), top.end(), maxlen);
+}
+
+// OPTION #4: Output the grades at a few percentiles, and then every ranked student in order of rank.
+void output_records_percentiles(ostream& out, v_iter b, v_iter e, str_sz maxlen)
+{
+    Profile_scope timer("output_records_percentiles");
+    vector<double> grades;
+    for (v_iter i = b; i != e; ++i) {
+        if (i->valid())
+            grades.push_back(i->grade());
+    }
+
+    out << "\n--- PERCENTILES ---" << endl;
+    if (grades.empty()) {
+        out << "(no graded students)" << endl;
+        return;
+    }
+    char line[64];
+    for (size_t i = 0; i != sizeof(cutoff_percentiles) / sizeof(*cutoff_percentiles); ++i) {
+        snprintf(line, sizeof(line), "%2.0fth percentile: %.1f", cutoff_percentiles[i],
+                 percentile_cutoff(grades, cutoff_percentiles[i]));
+        out << line << endl;
+    }
+
+    Rank_index index(b, e);
+    vector<size_t> positions;
+    index.ranked(1, index.size(), positions);
+    out << "\n--- STUDENTS BY RANK ---" << endl;
+    write_rank_table(out, b, index, positions, maxlen);
+}
+
+// OPTION #5: Answer queries about ranks (read from the standard input) from an index built once.
+void output_rank_queries(ostream& out, v_iter b, v_iter e, str_sz maxlen)
+{
+    Profile_scope timer("output_rank_queries");
+    Rank_index index(b, e);
+
+    cout << "Enter queries, one per line, followed by end-of-file (or an empty line):\n"
+            "  rank <name>   the rank and percentile of a student\n"
+            "  ranks <a> <b> the students ranked a to b\n"
+            "  top <k>       the top k students" << endl;
+
+    string line;
+    while (getline(cin, line) && !trim(line).empty()) {
+        istringstream query(line);
+        string command, name;
+        // (read as signed numbers, so that a negative rank is caught rather than wrapping round to a huge one)
+        long long first = 0, last = 0;
+        Rank_index::size_type pos;
+        vector<size_t> positions;
+
+        query >> command;
+        out << "\n> " << line << endl;
+        if (command == "rank" && query >> name) {
+            if (!index.find(name, pos))
+                out << "No record for \'" << name << "\'." << endl;
+            else if (index.rank(pos) == 0)
+                out << name << " has no grade (no h/w), so no rank." << endl;
+            else {
+                char text[64];
+                snprintf(text, sizeof(text), "%.1f", index.percentile(pos));
+                out << name << ": rank " << index.rank(pos) << " / " << index.size()
+                    << ", percentile " << text << endl;
+            }
+        }
+        else if (command == "ranks" && query >> first >> last) {
+            if (first < 0 || last < 0)
+                out << "Ranks cannot be negative." << endl;
+            else if (first > last)
+                out << "The first rank (" << first << ") cannot come after the last (" << last << ")." << endl;
+            else {
+                index.ranked(first, last, positions);
+                write_rank_table(out, b, index, positions, maxlen);
+            }
+        }
+        else if (command == "top" && query >> last) {
+            if (last < 0)
+                out << "The number of students cannot be negative." << endl;
+            else {
+                index.top(last, positions);
+                write_rank_table(out, b, index, positions, maxlen);
+            }
+        }
+        else {
+            out << "Unknown query." << endl;
+        }
+    }
+}
+
+// ---------------------------------- Pass marks (see Grade_index.h) ----------------------------------
+
+// writes a table of the records at the given positions of [b, e), in the order given (as output_records())
+static void output_positions(ostream& out, v_iter b, Grade_index::const_iterator first,
+                             Grade_index::const_iterator last, str_sz maxlen, bool lg)
+{
+    string border = write_report_header(out, maxlen);
+    Row_formatter rows(out, maxlen);
+    for (; first != last; ++first)
+        rows.row(b[*first], lg);
+    rows.line(border);
+    rows.flush();
+}
+
+// OPTION #6: Answer queries about pass marks and ranges of grades (read from the standard input) from an index built once.
+void output_threshold_queries(ostream& out, v_iter b, v_iter e, str_sz maxlen)
+{
+    Profile_scope timer("output_threshold_queries");
+    Grade_index index(b, e);
+
+    cout << "Enter queries, one per line, followed by end-of-file (or an empty line):\n"
+            "  count <mark>     the number of students who pass and fail with a pass mark\n"
+            "  pass <mark>      the students who pass and fail with a pass mark\n"
+            "  range <lo> <hi>  the students with grades from lo up to (not including) hi" << endl;
+
+    string line;
+    while (getline(cin, line) && !trim(line).empty()) {
+        istringstream query(line);
+        string command;
+        double lo = 0, hi = 0;
+
+        query >> command;
+        out << "\n> " << line << endl;
+        if ((command == "count" || command == "pass") && query >> lo) {
+            Grade_index::View passed = index.passes(lo), failed = index.fails(lo);
+            out << passed.size() << " passed, " << failed.size() << " failed." << endl;
+            if (command == "pass") {
+                // (each view is in order of grade: their positions are sorted to list them in roster order,
+                //  as output_records_passfail() does)
+                vector<size_t> p(passed.begin(), passed.end()), f(failed.begin(), failed.end());
+                sort(p.begin(), p.end());
+                sort(f.begin(), f.end());
+                out << "\n--- STUDENTS WHO PASSED ---" << endl;
+                output_positions(out, b, p.begin(), p.end(), maxlen, true);
+                out << "\n--- STUDENTS WHO FAILED ---" << endl;
+                output_positions(out, b, f.begin(), f.end(), maxlen, false);
+            }
+        }
+        else if (command == "range" && query >> lo >> hi) {
+            Grade_index::View range = index.between(lo, hi);
+            out << range.size() << " students." << endl;
+            output_positions(out, b, range.begin(), range.end(), maxlen, true);
+        }
+        else {
+            out << "Unknown query." << endl;
+        }
+    }
+}
@@ -1,6 +1,7 @@
 #ifndef GUARD_options_h
 #define GUARD_options_h
 
+#include <cstddef>
 #include <iostream>
 #include <map>
 #include <string>
@@ -47,6 +48,86 @@ void output_records_std(std::ostream&, v_iter, v_iter, str_sz);
  **/
 void output_records_passfail(std::ostream&, v_iter, v_iter, str_sz);
 
+/**
+ * Output the top 10 students (with the highest grades), found without sorting the roster (see top_k()).
+ **/
+void output_records_top(std::ostream&, v_iter, v_iter, str_sz);
+
+/**
+ * Output the grades at the 90th, 75th, 50th, 25th and 10th percentiles (see percentile_cutoff()),
+ * followed by every graded student in order of rank, with their rank and percentile.
+ **/
+void output_records_percentiles(std::ostream&, v_iter, v_iter, str_sz);
+
+/**
+ * Builds a Rank_index of the records bound by iterators [b, e), then reads queries from the standard
+ * input ("rank <name>", "ranks <a> <b>", "top <k>"), writing the answer to each as it is read.
+ **/
+void output_rank_queries(std::ostream&, v_iter, v_iter, str_sz);
+
+/**
+ * Builds a Grade_index of the records bound by iterators [b, e), then reads queries from the standard
+ * input ("count <mark>", "pass <mark>", "range <lo> <hi>"), writing the answer to each as it is read.
+ **/
+void output_threshold_queries(std::ostream&, v_iter, v_iter, str_sz);
+
+/**
+ * =====================
+ * THE PARTS OF A REPORT
+ * =====================
+ * Every output option writes its records as one or more tables, each made up of a header
+ * (the column labels between two borders), one row per record, and a footer border.
+ * These are available separately for output that is written a few records at a time
+ * (see Report_writer).
+ **/
+
+// the width of the name column, given the length of the longest name
+str_sz report_name_width(str_sz);
+// writes the header of a table of records, returning the border line (to be used as the footer)
+std::string write_report_header(std::ostream&, str_sz);
+// writes a single row (name, grade, and letter grade if the bool is true) of a table of records
+void write_report_row(std::ostream&, const Student_info&, str_sz, bool);
+
+/**
+ * ==================
+ * THE ROW FORMATTER
+ * ==================
+ * Writing each row through the stream means building padding strings for every row, switching the
+ * stream to fixed-point notation and back, and flushing it with endl at the end of every line.
+ *
+ * A Row_formatter instead renders rows into a buffer of its own (re-used for its whole life), taking
+ * each name's padding from a single string of spaces made once. Each grade is written by hand, to one
+ * decimal place: it is rounded to a whole number of tenths, which is then checked against the exact
+ * halfway points either side of it with std::fma (so it rounds just as printf("%.1f") does), and its
+ * digits are written out directly. (Only grades too large for that, beyond +/-1e13, go through
+ * std::to_chars instead.) The buffer is written to the stream in one go whenever it fills up, and when
+ * the formatter is flushed or destroyed. The bytes written are exactly the same as write_report_row()'s.
+ **/
+class Row_formatter {
+public:
+    // formats rows for the given stream and padding factor, writing out every 'capacity' bytes or so.
+    Row_formatter(std::ostream&, str_sz, std::size_t capacity = 1 << 16);
+    ~Row_formatter() { flush(); }
+
+    // adds a single row (name, grade, and letter grade if the bool is true)
+    void row(const Student_info&, bool);
+    // adds a line of text (such as a border)
+    void line(const std::string&);
+    // writes out everything added so far
+    void flush();
+
+private:
+    std::ostream& out;
+    str_sz width;               // the width of the name column
+    std::size_t capacity;
+    std::string buf;
+    std::string spaces;         // enough spaces to pad any name (or the grade before the letter grade)
+
+    // (copying a formatter would write its rows twice)
+    Row_formatter(const Row_formatter&);
+    Row_formatter& operator=(const Row_formatter&);
+};
+
 /**
  * Has the user input an option, out of a given range of them, for how to output the student grades.
  **/
@@ -0,0 +1,43 @@
+#include <iomanip>
+using std::setw;
+
+#include <ios>
+using std::fixed;
+using std::left;
+using std::right;
+using std::streamsize;
+
+#include <iostream>
+using std::endl;
+using std::ostream;
+
+#include <vector>
+using std::vector;
+
+#include "Pipeline.h"
+
+
+void write_stage_stats(ostream& out, const vector<Stage_stats>& stats)
+{
+    // save the stream's formatting, to restore it afterwards.
+    std::ios::fmtflags flags = out.flags();
+    streamsize prec = out.precision();
+
+    out << left << setw(10) << "STAGE" << right
+        << setw(10) << "BATCHES" << setw(12) << "ITEMS"
+        << setw(10) << "BUSY (s)" << setw(10) << "TOTAL (s)" << setw(14) << "ITEMS/BUSY s" << endl;
+
+    for (vector<Stage_stats>::const_iterator s = stats.begin(); s != stats.end(); ++s) {
+        // (a stage that did no work has no meaningful throughput)
+        double rate = s->busy_seconds > 0 ? s->items / s->busy_seconds : 0;
+
+        out << left << setw(10) << s->name << right
+            << setw(10) << s->batches << setw(12) << s->items
+            << fixed << std::setprecision(3)
+            << setw(10) << s->busy_seconds << setw(10) << s->total_seconds
+            << std::setprecision(0) << setw(14) << rate << endl;
+    }
+
+    out.flags(flags);
+    out.precision(prec);
+}
@@ -0,0 +1,200 @@
+#ifndef GUARD_Pipeline_h
+#define GUARD_Pipeline_h
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * ==================
+ * A STAGED PIPELINE
+ * ==================
+ * A pipeline splits a job into a chain of stages (e.g. read -> parse -> grade -> write), each
+ * running on its own thread, with each stage passing its results on to the next through a queue.
+ * While one stage waits for the disk, the others can keep working on what has already been read.
+ *
+ * The queues are bounded: once a queue is full, the stage feeding it waits until the next stage
+ * has taken something out ("back-pressure"). So however large the input is, the memory used is
+ * limited to what fits in the queues.
+ **/
+
+/**
+ * A fixed-capacity queue between exactly one producer thread and one consumer thread.
+ *
+ * A side that has to wait (the producer for space, or the consumer for an element) sleeps on a
+ * condition variable until the other side wakes it, rather than spinning, so a stage that is
+ * blocked (say, the writer waiting on the disk) leaves its core free for the stages that can work.
+ *
+ * ===============
+ * CLASS INVARIANT
+ * ===============
+ * 1) head <= tail <= head + capacity
+ * 2) The elements waiting in the queue are slots[i % capacity] for i in [head, tail).
+ * (Both are only changed while holding the lock.)
+ **/
+template <class T> class Bounded_queue {
+public:
+    explicit Bounded_queue(std::size_t capacity):
+        slots(capacity ? capacity : 1), head(0), tail(0), closed(false), full_waits(0) { }
+
+    /**
+     * Adds an element to the back of the queue, waiting for space if it is full.
+     * (Only to be called by the producer.)
+     **/
+    void push(T& t) {
+        std::unique_lock<std::mutex> guard(lock);
+        if (tail - head == slots.size()) {
+            ++full_waits;
+            not_full.wait(guard, [this] { return tail - head != slots.size(); });
+        }
+        // move the element in (swapping avoids copying large batches)
+        std::swap(slots[tail % slots.size()], t);
+        ++tail;
+        guard.unlock();
+        not_empty.notify_one();
+    }
+
+    /**
+     * Removes the element at the front of the queue, waiting for one if it is empty.
+     * Returns false (without changing t) once the queue is empty and has been closed.
+     * (Only to be called by the consumer.)
+     **/
+    bool pop(T& t) {
+        std::unique_lock<std::mutex> guard(lock);
+        not_empty.wait(guard, [this] { return head != tail || closed; });
+        if (head == tail)
+            return false;
+        std::swap(t, slots[head % slots.size()]);
+        ++head;
+        guard.unlock();
+        not_full.notify_one();
+        return true;
+    }
+
+    // marks that nothing more will be pushed (only to be called by the producer).
+    void close() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            closed = true;
+        }
+        not_empty.notify_one();
+    }
+
+    // the number of times the producer had to wait for space.
+    std::size_t waits() const { return full_waits; }
+
+private:
+    std::vector<T> slots;
+    std::size_t head, tail;
+    bool closed;
+    std::size_t full_waits;
+
+    std::mutex lock;
+    std::condition_variable not_full, not_empty;
+
+    // (copying a queue would make no sense)
+    Bounded_queue(const Bounded_queue&);
+    Bounded_queue& operator=(const Bounded_queue&);
+};
+
+/**
+ * The throughput counters of a single stage: how many batches and items it has processed, and
+ * how long it spent working on them (as opposed to waiting on its queues).
+ **/
+struct Stage_stats {
+    std::string name;
+    std::size_t batches, items;
+    double busy_seconds, total_seconds;
+
+    explicit Stage_stats(const std::string& n = ""):
+        name(n), batches(0), items(0), busy_seconds(0), total_seconds(0) { }
+};
+
+// writes a table of the counters of every stage of a pipeline
+void write_stage_stats(std::ostream&, const std::vector<Stage_stats>&);
+
+// the number of seconds since some fixed point in time, for timing the stages.
+inline double pipeline_clock()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * ===========
+ * STAGE TYPES
+ * ===========
+ * Each of the functions below runs the body of a single stage until its input runs out, then
+ * closes its output queue so that the next stage knows to finish too. They are meant to be
+ * the function run by each of the threads of a pipeline.
+ *
+ * The size of a batch (for the items counter) is found through its size() member.
+ **/
+
+/**
+ * A source stage, which has no input queue. The body fills a batch and returns false once
+ * there is nothing more to produce.
+ **/
+template <class Out, class Body>
+void run_source(Body body, Bounded_queue<Out>& out, Stage_stats& stats)
+{
+    double start = pipeline_clock();
+    for (;;) {
+        Out batch;
+        double t = pipeline_clock();
+        bool more = body(batch);
+        stats.busy_seconds += pipeline_clock() - t;
+
+        if (batch.size() != 0) {
+            ++stats.batches;
+            stats.items += batch.size();
+            out.push(batch);
+        }
+        if (!more)
+            break;
+    }
+    out.close();
+    stats.total_seconds = pipeline_clock() - start;
+}
+
+// A middle stage, where the body turns each batch from its input queue into a batch for its output.
+template <class In, class Out, class Body>
+void run_stage(Bounded_queue<In>& in, Body body, Bounded_queue<Out>& out, Stage_stats& stats)
+{
+    double start = pipeline_clock();
+    In batch;
+    while (in.pop(batch)) {
+        Out result;
+        double t = pipeline_clock();
+        body(batch, result);
+        stats.busy_seconds += pipeline_clock() - t;
+
+        ++stats.batches;
+        stats.items += batch.size();
+        out.push(result);
+    }
+    out.close();
+    stats.total_seconds = pipeline_clock() - start;
+}
+
+// A sink stage, which has no output queue.
+template <class In, class Body>
+void run_sink(Bounded_queue<In>& in, Body body, Stage_stats& stats)
+{
+    double start = pipeline_clock();
+    In batch;
+    while (in.pop(batch)) {
+        double t = pipeline_clock();
+        body(batch);
+        stats.busy_seconds += pipeline_clock() - t;
+
+        ++stats.batches;
+        stats.items += batch.size();
+    }
+    stats.total_seconds = pipeline_clock() - start;
+}
+
+#endif
@@ -0,0 +1,244 @@
+#include <cstddef>
+using std::size_t;
+
+#include <cstdio>
+using std::snprintf;
+
+#include <fstream>
+using std::ofstream;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+using std::ostream;
+
+#include <map>
+using std::map;
+
+#include <mutex>
+using std::lock_guard;
+using std::mutex;
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "Profile.h"
+
+
+bool profile_on = false;
+
+// the most scopes traced by each thread (every one is still counted in the summary)
+static const size_t max_trace_events = 1 << 20;
+
+// the totals of one scope (or counter) on one thread
+struct Scope_total {
+    const char* name;
+    long long calls, total, longest;    // (a counter only uses total)
+};
+
+// one scope that ran, for the trace
+struct Trace_event {
+    const char* name;
+    long long start, end;
+};
+
+// everything recorded by a single thread
+struct Thread_profile {
+    int id;
+    vector<Scope_total> scopes, counters;
+    vector<Trace_event> events;
+    long long dropped;      // the number of scopes too many to trace
+};
+
+// every thread's buffers (only locked when a thread records something for the first time), and when the run started
+static mutex registry_lock;
+static vector<Thread_profile*> registry;
+static long long run_start;
+
+// the buffers of the calling thread, made (and registered) the first time it needs them.
+// (they are never deleted, as they must last until the run is over, even if the thread has finished)
+static Thread_profile& this_thread()
+{
+    static thread_local Thread_profile* local = 0;
+    if (!local) {
+        local = new Thread_profile;
+        local->dropped = 0;
+        lock_guard<mutex> guard(registry_lock);
+        local->id = int(registry.size());
+        registry.push_back(local);
+    }
+    return *local;
+}
+
+// the totals for a name in a list of them, added if not there yet.
+// (names are compared by address, as each comes from a single literal, and a thread only ever uses a few of them)
+static Scope_total& total_for(vector<Scope_total>& totals, const char* name)
+{
+    for (vector<Scope_total>::iterator t = totals.begin(); t != totals.end(); ++t) {
+        if (t->name == name)
+            return *t;
+    }
+    Scope_total t = { name, 0, 0, 0 };
+    totals.push_back(t);
+    return totals.back();
+}
+
+void profile_scope_done(const char* name, long long start, long long end)
+{
+    Thread_profile& p = this_thread();
+    Scope_total& t = total_for(p.scopes, name);
+    long long d = end - start;
+    ++t.calls;
+    t.total += d;
+    if (d > t.longest)
+        t.longest = d;
+
+    if (p.events.size() < max_trace_events) {
+        Trace_event e = { name, start, end };
+        p.events.push_back(e);
+    }
+    else {
+        ++p.dropped;
+    }
+}
+
+void profile_add(const char* name, long long n)
+{
+    total_for(this_thread().counters, name).total += n;
+}
+
+// ---------------------------------- Reports ----------------------------------
+
+// writes a string as a JSON string (in quotes, with any special characters escaped)
+static void write_json_string(ostream& out, const char* s)
+{
+    out << '"';
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\')
+            out << '\\' << *s;
+        else if ((unsigned char) *s < 0x20) {
+            char esc[8];
+            snprintf(esc, sizeof(esc), "\\u%04x", (unsigned char) *s);
+            out << esc;
+        }
+        else
+            out << *s;
+    }
+    out << '"';
+}
+
+// nanoseconds as a number of milliseconds or microseconds (to the nearest nanosecond)
+static string ms(long long ns)
+{
+    char s[32];
+    snprintf(s, sizeof(s), "%.6f", ns / 1e6);
+    return s;
+}
+
+static string us(long long ns)
+{
+    char s[32];
+    snprintf(s, sizeof(s), "%.3f", ns / 1e3);
+    return s;
+}
+
+// the totals of every thread added together, by name (in alphabetical order)
+struct Merged_total {
+    long long calls, total, longest;
+    int threads;
+    Merged_total(): calls(0), total(0), longest(0), threads(0) { }
+};
+
+static void merge_totals(const vector<Scope_total>& totals, map<string, Merged_total>& merged)
+{
+    for (vector<Scope_total>::const_iterator t = totals.begin(); t != totals.end(); ++t) {
+        Merged_total& m = merged[t->name];
+        m.calls += t->calls;
+        m.total += t->total;
+        if (t->longest > m.longest)
+            m.longest = t->longest;
+        ++m.threads;
+    }
+}
+
+static bool write_summary(const string& path, long long wall)
+{
+    map<string, Merged_total> scopes, counters;
+    long long traced = 0, dropped = 0;
+    for (vector<Thread_profile*>::const_iterator p = registry.begin(); p != registry.end(); ++p) {
+        merge_totals((*p)->scopes, scopes);
+        merge_totals((*p)->counters, counters);
+        traced += (*p)->events.size();
+        dropped += (*p)->dropped;
+    }
+
+    ofstream out(path.c_str());
+    out << "{\n  \"wall_ms\": " << ms(wall) << ",\n  \"threads\": " << registry.size() << ",\n  \"scopes\": [";
+    for (map<string, Merged_total>::const_iterator s = scopes.begin(); s != scopes.end(); ++s) {
+        out << (s == scopes.begin() ? "\n" : ",\n") << "    { \"name\": ";
+        write_json_string(out, s->first.c_str());
+        out << ", \"calls\": " << s->second.calls
+            << ", \"total_ms\": " << ms(s->second.total)
+            << ", \"mean_us\": " << us(s->second.total / s->second.calls)
+            << ", \"longest_ms\": " << ms(s->second.longest)
+            << ", \"threads\": " << s->second.threads << " }";
+    }
+    out << "\n  ],\n  \"counters\": [";
+    for (map<string, Merged_total>::const_iterator c = counters.begin(); c != counters.end(); ++c) {
+        out << (c == counters.begin() ? "\n" : ",\n") << "    { \"name\": ";
+        write_json_string(out, c->first.c_str());
+        out << ", \"value\": " << c->second.total << " }";
+    }
+    out << "\n  ],\n  \"traced_scopes\": " << traced << ",\n  \"untraced_scopes\": " << dropped << "\n}\n";
+    return bool(out);
+}
+
+static bool write_trace(const string& path, long long end)
+{
+    ofstream out(path.c_str());
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    bool first = true;
+    for (vector<Thread_profile*>::const_iterator p = registry.begin(); p != registry.end(); ++p) {
+        // each scope is a "complete" event (ph X), with its start and duration in microseconds
+        for (vector<Trace_event>::const_iterator e = (*p)->events.begin(); e != (*p)->events.end(); ++e) {
+            out << (first ? "" : ",\n") << "{\"ph\": \"X\", \"pid\": 1, \"tid\": " << (*p)->id << ", \"name\": ";
+            write_json_string(out, e->name);
+            out << ", \"ts\": " << us(e->start - run_start) << ", \"dur\": " << us(e->end - e->start) << "}";
+            first = false;
+        }
+        // and each counter's final value is a "counter" event (ph C) at the end of the run
+        for (vector<Scope_total>::const_iterator c = (*p)->counters.begin(); c != (*p)->counters.end(); ++c) {
+            out << (first ? "" : ",\n") << "{\"ph\": \"C\", \"pid\": 1, \"tid\": " << (*p)->id << ", \"name\": ";
+            write_json_string(out, c->name);
+            out << ", \"ts\": " << us(end - run_start) << ", \"args\": {\"value\": " << c->total << "}}";
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+    return bool(out);
+}
+
+Profile_session::Profile_session(bool o, const string& summary, const string& trace):
+    on(o), summary_path(summary), trace_path(trace)
+{
+    if (on) {
+        run_start = profile_clock();
+        profile_on = true;
+    }
+}
+
+Profile_session::~Profile_session()
+{
+    if (!on)
+        return;
+    long long end = profile_clock();
+    profile_on = false;
+
+    if (write_summary(summary_path, end - run_start) && write_trace(trace_path, end))
+        cout << "Profile written to \'" << summary_path << "\' (trace in \'" << trace_path << "\')." << endl;
+    else
+        cout << "Could not write the profile." << endl;
+}
@@ -0,0 +1,91 @@
+#ifndef GUARD_Profile_h
+#define GUARD_Profile_h
+
+#include <chrono>
+#include <string>
+
+/**
+ * ===========
+ * PROFILING
+ * ===========
+ * To find out where the time of a run goes, parts of the program are marked as named SCOPES, each
+ * timed from where a Profile_scope is made to the end of the block it is made in, and events are
+ * added up in named COUNTERS:
+ *
+ *      {
+ *          Profile_scope timer("sort");        // times the rest of this block, as "sort"
+ *          ...
+ *      }
+ *      profile_count("records read", n);       // adds n to the counter "records read"
+ *
+ * Each thread records its scopes and counters into buffers of its own (so threads never wait for
+ * each other to record anything), which are only gathered up once the run is over, into:
+ *  - a SUMMARY (JSON): for each scope, the number of times it ran, and its total, mean and longest
+ *    times, and the final value of each counter (adding up every thread's),
+ *  - a TRACE (JSON, in the "trace event" format that Chrome's about://tracing or Perfetto can show):
+ *    each scope that ran, on its own thread's timeline. (To keep the file to a sensible size, only
+ *    the first million scopes of each thread are traced, though every one is in the summary.)
+ *
+ * While profiling is off (as it is unless a Profile_session turns it on), making a Profile_scope
+ * or counting only checks a single flag, and does nothing else.
+ **/
+
+// whether profiling is on (only to be changed by a Profile_session)
+extern bool profile_on;
+
+// the time now, in nanoseconds (since some fixed point in time)
+inline long long profile_clock()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// (record a finished scope, and add to a counter, in the calling thread's buffers)
+void profile_scope_done(const char* name, long long start, long long end);
+void profile_add(const char* name, long long n);
+
+// adds to a counter (the name must be a string that lasts the whole run, such as a literal)
+inline void profile_count(const char* name, long long n = 1)
+{
+    if (profile_on)
+        profile_add(name, n);
+}
+
+// times the block it is made in (the name must be a string that lasts the whole run, such as a literal)
+class Profile_scope {
+public:
+    explicit Profile_scope(const char* n): name(n), start(profile_on ? profile_clock() : 0) { }
+    ~Profile_scope()
+    {
+        if (profile_on)
+            profile_scope_done(name, start, profile_clock());
+    }
+
+private:
+    const char* name;
+    long long start;
+
+    // (copying a scope would time it twice)
+    Profile_scope(const Profile_scope&);
+    Profile_scope& operator=(const Profile_scope&);
+};
+
+/**
+ * Turns profiling on for the whole life of the session (if asked to), and writes the summary and the
+ * trace to the given files when it ends. Meant to be made at the start of main(), so that it ends when
+ * main() returns, after every other thread has finished.
+ **/
+class Profile_session {
+public:
+    Profile_session(bool on, const std::string& summary_path, const std::string& trace_path);
+    ~Profile_session();
+
+private:
+    bool on;
+    std::string summary_path, trace_path;
+
+    Profile_session(const Profile_session&);
+    Profile_session& operator=(const Profile_session&);
+};
+
+#endif
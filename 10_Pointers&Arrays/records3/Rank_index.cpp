@@ -0,0 +1,186 @@
+#include <algorithm>
+using std::lower_bound;
+using std::nth_element;
+using std::pop_heap;
+using std::push_heap;
+using std::sort;
+using std::sort_heap;
+using std::upper_bound;
+
+#include <cmath>
+using std::ceil;
+
+#include <cstddef>
+using std::size_t;
+
+#include <functional>
+using std::greater;
+
+#include <stdexcept>
+using std::domain_error;
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "Name_sort.h"
+#include "Rank_index.h"
+#include "Student_info.h"
+
+
+// the sort key of a ranked record: its grade (read once, rather than on every comparison), and its position.
+struct Rank_key {
+    double grade;
+    size_t index;
+};
+
+// does x rank above y? (a higher grade, or the same grade and an earlier name, or the same name and read earlier)
+class Rank_less {
+public:
+    Rank_less(roster_iter s): students(s) { }
+    bool operator()(const Rank_key& x, const Rank_key& y) const {
+        if (x.grade != y.grade)
+            return x.grade > y.grade;
+        int c = students[x.index].name().compare(students[y.index].name());
+        return c != 0 ? c < 0 : x.index < y.index;
+    }
+private:
+    roster_iter students;
+};
+
+/**
+ * The compact sort key a Rank_index sorts by: the grade, and a "name id" (the record's place in name
+ * order, in which records of the same name are already in the order they were read), along with the
+ * record's position. Ranking by (grade descending, name id ascending) gives exactly the order of
+ * Rank_less, but compares two numbers rather than two names, and moves 24 bytes rather than a record.
+ **/
+struct Rank_sort_key {
+    double grade;
+    size_t name_id;
+    size_t index;
+};
+
+inline bool rank_key_less(const Rank_sort_key& x, const Rank_sort_key& y)
+{
+    return x.grade != y.grade ? x.grade > y.grade : x.name_id < y.name_id;
+}
+
+void top_k(roster_iter students, roster_iter e, size_t k, vector<size_t>& out)
+{
+    /**
+     * The heap holds the best k records found so far, with the LOWEST ranked of them on top, so that
+     * each new record only has to beat that one to get in (replacing it).
+     **/
+    Rank_less less(students);
+    vector<Rank_key> heap;
+    heap.reserve(k);
+    const size_t n = e - students;
+    for (size_t i = 0; i != n && k != 0; ++i) {
+        if (!students[i].valid())
+            continue;
+        Rank_key key = { students[i].grade(), i };
+        if (heap.size() < k) {
+            heap.push_back(key);
+            push_heap(heap.begin(), heap.end(), less);
+        }
+        else if (less(key, heap.front())) {
+            pop_heap(heap.begin(), heap.end(), less);
+            heap.back() = key;
+            push_heap(heap.begin(), heap.end(), less);
+        }
+    }
+
+    // (sorting a heap leaves it in order, best first)
+    sort_heap(heap.begin(), heap.end(), less);
+    out.clear();
+    for (vector<Rank_key>::const_iterator h = heap.begin(); h != heap.end(); ++h)
+        out.push_back(h->index);
+}
+
+double percentile_cutoff(vector<double>& grades, double p)
+{
+    if (grades.empty())
+        throw domain_error("percentile of an empty list of grades");
+
+    // the grade at position ceil(p% of n) (counting from 1) in increasing order
+    double n = ceil(p / 100 * grades.size());
+    vector<double>::size_type k = n < 1 ? 0 : n > grades.size() ? grades.size() - 1 : size_t(n) - 1;
+
+    nth_element(grades.begin(), grades.begin() + k, grades.end());
+    return grades[k];
+}
+
+Rank_index::Rank_index(roster_iter b, roster_iter e): students(b)
+{
+    const size_type n = e - b;
+
+    // (the roster may not be in name order already, so the names are sorted for find(), see Name_sort.h)
+    // (each record's place in that order is its name id)
+    name_order(b, e, by_name);
+    vector<size_t> name_id(n);
+    for (size_type r = 0; r != n; ++r)
+        name_id[by_name[r]] = r;
+
+    // sort the compact keys of the ranked records, once
+    vector<Rank_sort_key> keys;
+    keys.reserve(n);
+    for (size_type i = 0; i != n; ++i) {
+        if (students[i].valid()) {
+            Rank_sort_key key = { students[i].grade(), name_id[i], i };
+            keys.push_back(key);
+        }
+    }
+    sort(keys.begin(), keys.end(), rank_key_less);
+
+    by_rank.reserve(keys.size());
+    grades.reserve(keys.size());
+    place.assign(n, keys.size());
+    for (vector<Rank_sort_key>::size_type r = 0; r != keys.size(); ++r) {
+        by_rank.push_back(keys[r].index);
+        grades.push_back(keys[r].grade);
+        place[keys[r].index] = r;
+    }
+}
+
+void Rank_index::ranked(size_type a, size_type b, vector<size_type>& out) const
+{
+    if (a < 1)
+        a = 1;
+    if (b > size())
+        b = size();
+    out.clear();
+    if (a <= b)
+        out.assign(by_rank.begin() + (a - 1), by_rank.begin() + b);
+}
+
+bool Rank_index::find(const string& name, size_type& pos) const
+{
+    vector<size_t>::const_iterator i = lower_bound(by_name.begin(), by_name.end(), name,
+        [this](size_t p, const string& n) { return students[p].name() < n; });
+    if (i == by_name.end() || students[*i].name() != name)
+        return false;
+    pos = *i;
+    return true;
+}
+
+Rank_index::size_type Rank_index::rank(size_type pos) const
+{
+    if (place[pos] == size())
+        return 0;
+
+    // (the grades are in decreasing order, so those higher than this one are all before it)
+    double g = grades[place[pos]];
+    return lower_bound(grades.begin(), grades.end(), g, greater<double>()) - grades.begin() + 1;
+}
+
+double Rank_index::percentile(size_type pos) const
+{
+    if (place[pos] == size())
+        return 0;
+
+    double g = grades[place[pos]];
+    size_type lower = grades.end() - upper_bound(grades.begin(), grades.end(), g, greater<double>());
+    return 100.0 * lower / size();
+}
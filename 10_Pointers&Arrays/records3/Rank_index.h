@@ -0,0 +1,78 @@
+#ifndef GUARD_Rank_index_h
+#define GUARD_Rank_index_h
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Student_info.h"
+
+/**
+ * ==============
+ * RANKING
+ * ==============
+ * Students are ranked by their grade, highest first, with students of the same grade in alphabetical
+ * order (and students of the same name in the order they were read). Records that are not valid have
+ * no grade, and so no rank.
+ *
+ * Sorting the whole roster by grade just to find the top few students, or one student's rank, does far
+ * more work than needed. Instead:
+ *  - top_k() finds the top K students with a "heap" of the best K found so far, looking at each record
+ *    only once, in O(n log K) time,
+ *  - percentile_cutoff() finds the grade at a percentile with std::nth_element (a selection, rather
+ *    than a sort, see order_stats.h), in O(n) time on average,
+ *  - a Rank_index sorts the roster by rank ONCE, after which it answers "the rank of student X" in
+ *    O(log n) time, and "the students ranked a to b" (or "the top K") in O(K) time.
+ **/
+
+// the positions of the (at most) k highest ranked records in a roster, in rank order.
+void top_k(roster_iter b, roster_iter e, std::size_t k, std::vector<std::size_t>&);
+
+/**
+ * The grade at the p-th percentile (0 to 100) of a list of grades: the lowest grade that at least
+ * p percent of the grades are no higher than (so the 50th percentile is the median, rounded down to
+ * one of the grades). The grades are re-ordered. Throws domain_error if there are no grades.
+ **/
+double percentile_cutoff(std::vector<double>&, double p);
+
+class Rank_index {
+public:
+    typedef std::vector<Student_info>::size_type size_type;
+
+    // indexes a roster, which must not change (or move) while the index is used.
+    Rank_index(roster_iter b, roster_iter e);
+
+    // the number of ranked (i.e. valid) records
+    size_type size() const { return by_rank.size(); }
+
+    // the position in the roster of the record of the given rank (from 1 to size())
+    size_type at(size_type rank) const { return by_rank[rank - 1]; }
+
+    // the positions of the records ranked a to b (inclusive, and cut down to 1 to size()), in rank order
+    void ranked(size_type a, size_type b, std::vector<size_type>&) const;
+
+    // the positions of the top k records, in rank order
+    void top(size_type k, std::vector<size_type>& out) const { ranked(1, k, out); }
+
+    // finds the position of the (first) record with the given name, returning false if there is none.
+    bool find(const std::string&, size_type&) const;
+
+    /**
+     * The rank of the record at a position, counting students of the same grade as sharing the highest
+     * rank among them (so two students tied for first place are both 1st, and the next student is 3rd).
+     * Returns 0 for a record with no rank.
+     **/
+    size_type rank(size_type) const;
+
+    // the percentage of ranked students with a lower grade than the record at a position (0 if unranked).
+    double percentile(size_type) const;
+
+private:
+    roster_iter students;
+    std::vector<size_type> by_rank;     // the positions of the ranked records, in rank order
+    std::vector<double> grades;         // their grades, in the same order (highest first)
+    std::vector<size_type> place;       // where each record is in by_rank (size() if unranked)
+    std::vector<std::size_t> by_name;   // the positions of every record, in name order
+};
+
+#endif
@@ -0,0 +1,343 @@
+#include <algorithm>
+using std::max;
+
+#include <cstring>
+using std::memcmp;
+
+#include <iostream>
+using std::istream;
+using std::ostream;
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "Profile.h"
+#include "Roster_bin.h"
+#include "Student_info.h"
+#include "Student_table.h"
+
+
+const char roster_bin_magic[4] = { 'S', 'R', 'B', '1' };
+
+// the version of the layout described in Roster_bin.h
+// (version 1 stored 64-bit offsets, and version 2 no grades; neither is read any more)
+static const unsigned roster_bin_version = 3;
+
+// type mnemonics for the fixed-size fields of the file
+typedef unsigned long long u64;
+
+/**
+ * The header found at the start of every binary roster file, holding the sizes needed to
+ * locate each of the columns that follow it.
+ **/
+struct Roster_bin_header {
+    char magic[4];
+    unsigned version;
+    u64 count;          // number of student records
+    u64 length_bytes;   // size of the name lengths
+    u64 name_bytes;     // size of the name heap
+    u64 exam_bytes;     // size of the exam grades
+    u64 hw_bytes;       // size of the packed homework blocks
+    u64 grade_bytes;    // size of the final grades (8 bytes a record)
+};
+
+// ================= "Helper" functions for writing and reading columns ===================
+
+// write the raw bytes of a column of n values of type T
+template<class T>
+void write_column(ostream& out, const T* p, u64 n)
+{
+    if (n != 0)
+        out.write(reinterpret_cast<const char*>(p), n * sizeof(T));
+}
+template<class T>
+void write_column(ostream& out, const vector<T>& v)
+{
+    write_column(out, v.empty() ? 0 : &v[0], v.size());
+}
+
+// read a column of n values of type T, replacing the contents of v.
+template<class T>
+bool read_column(istream& in, vector<T>& v, u64 n)
+{
+    v.resize(n);
+    if (n != 0)
+        in.read(reinterpret_cast<char*>(&v[0]), n * sizeof(T));
+    return bool(in);
+}
+
+/**
+ * ==========================
+ * ZIGZAG AND VARINT ENCODING
+ * ==========================
+ * Zigzag encoding maps signed numbers to unsigned ones so that numbers close to zero (of either sign)
+ * stay small: 0 -> 0, -1 -> 1, 1 -> 2, -2 -> 3, 2 -> 4, ...
+ *
+ * A varint writes an unsigned number 7 bits at a time, using the top bit of each byte to mark
+ * whether another byte follows, so that small numbers only take a single byte.
+ **/
+unsigned zigzag(int x) { return (unsigned(x) << 1) ^ unsigned(x >> 31); }
+int unzigzag(unsigned u) { return int(u >> 1) ^ -int(u & 1); }
+
+void write_varint(vector<unsigned char>& out, unsigned x)
+{
+    while (x >= 0x80) {
+        out.push_back((unsigned char)(x | 0x80));
+        x >>= 7;
+    }
+    out.push_back((unsigned char)x);
+}
+
+// reads a varint from [p, end), returning one-past it (or 0 if it runs past the end, or is too long)
+const unsigned char* read_varint(const unsigned char* p, const unsigned char* end, unsigned& x)
+{
+    x = 0;
+    for (int shift = 0; p != end && shift <= 28; shift += 7) {
+        unsigned char b = *p++;
+        x |= unsigned(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return p;
+    }
+    return 0;
+}
+
+// the number of bits needed to write x.
+unsigned bit_width(unsigned x)
+{
+    unsigned w = 0;
+    while (x) {
+        ++w;
+        x >>= 1;
+    }
+    return w;
+}
+
+// ======================== Homework blocks ===========================
+
+/**
+ * A homework block is made up of:
+ *  - the number of homework grades n (a varint),
+ *  - if n > 0, the bit width w of the widest packed value (a single byte),
+ *  - n values of w bits each, packed from the lowest bit of each byte upwards.
+ *
+ * Each value packed is the (zigzag encoded) difference between a grade and the grade before it
+ * (the first grade is taken as a difference from 0). Since homework grades on the same scale
+ * tend to be close to each other, this usually takes 5-8 bits per grade instead of 32.
+ * (The width is at least 1, so a block of n grades always takes at least n bits, which is how
+ * a corrupt count is caught before anything is read for it.)
+ **/
+void pack_homework(const vector<int>& hw, vector<unsigned char>& out)
+{
+    write_varint(out, hw.size());
+    if (hw.empty())
+        return;
+
+    // compute the deltas, and the width needed to store the largest of them.
+    vector<unsigned> deltas(hw.size());
+    unsigned widest = 0;
+    int prev = 0;
+    for (vector<int>::size_type i = 0; i != hw.size(); ++i) {
+        deltas[i] = zigzag(hw[i] - prev);
+        widest = max(widest, deltas[i]);
+        prev = hw[i];
+    }
+    unsigned w = max(1u, bit_width(widest));
+    out.push_back((unsigned char)w);
+
+    // pack the deltas w bits at a time through a 64-bit accumulator.
+    u64 acc = 0;
+    unsigned bits = 0;
+    for (vector<unsigned>::size_type i = 0; i != deltas.size(); ++i) {
+        acc |= u64(deltas[i]) << bits;
+        bits += w;
+        while (bits >= 8) {
+            out.push_back((unsigned char)acc);
+            acc >>= 8;
+            bits -= 8;
+        }
+    }
+    if (bits != 0)
+        out.push_back((unsigned char)acc);
+}
+
+const unsigned char* unpack_homework(const unsigned char* p, const unsigned char* end, vector<int>& hw)
+{
+    hw.clear();
+
+    unsigned n;
+    p = read_varint(p, end, n);
+    if (p == 0 || n == 0)
+        return p;
+
+    // the width, and the bytes the n values take, must both fit.
+    if (p == end)
+        return 0;
+    unsigned w = *p++;
+    if (w < 1 || w > 32 || (u64(n) * w + 7) / 8 > u64(end - p))
+        return 0;
+    u64 mask = (u64(1) << w) - 1;
+
+    u64 acc = 0;
+    unsigned bits = 0;
+    int prev = 0;
+    for (unsigned i = 0; i != n; ++i) {
+        // top up the accumulator until it holds a whole value.
+        while (bits < w) {
+            acc |= u64(*p++) << bits;
+            bits += 8;
+        }
+        prev += unzigzag(unsigned(acc & mask));
+        hw.push_back(prev);
+        acc >>= w;
+        bits -= w;
+    }
+    return p;
+}
+
+// ======================== Whole files ===========================
+
+void write_roster_bin(ostream& out, const Student_table& table)
+{
+    typedef Student_table::size_type size_type;
+    const size_type n = table.size();
+    const vector<u64>& name_off = table.name_offsets();
+
+    // the variable-length columns: name lengths, exam grades and packed homework
+    vector<unsigned char> lengths, exams, hw;
+    vector<int> row_hw;
+    for (size_type i = 0; i != n; ++i) {
+        write_varint(lengths, unsigned(name_off[i + 1] - name_off[i]));
+        write_varint(exams, zigzag(table.midterm(i)));
+        write_varint(exams, zigzag(table.final(i)));
+        row_hw.assign(table.hw_begin(i), table.hw_end(i));
+        pack_homework(row_hw, hw);
+    }
+
+    Roster_bin_header h;
+    std::copy(roster_bin_magic, roster_bin_magic + 4, h.magic);
+    h.version = roster_bin_version;
+    h.count = n;
+    h.length_bytes = lengths.size();
+    h.name_bytes = table.name_heap().size();
+    h.exam_bytes = exams.size();
+    h.hw_bytes = hw.size();
+    h.grade_bytes = n * sizeof(double);
+
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    write_column(out, lengths);
+    write_column(out, table.name_heap().data(), h.name_bytes);
+    write_column(out, exams);
+    write_column(out, hw);
+    for (size_type i = 0; i != n; ++i) {
+        double g = table.grade(i);
+        out.write(reinterpret_cast<const char*>(&g), sizeof(g));
+    }
+}
+
+bool is_roster_bin(istream& in)
+{
+    char magic[4];
+    istream::pos_type start = in.tellg();
+
+    in.read(magic, 4);
+    bool found = in.gcount() == 4 && memcmp(magic, roster_bin_magic, 4) == 0;
+
+    // put the stream back to where it was, ready to be read either way.
+    in.clear();
+    in.seekg(start);
+    return found;
+}
+
+// the number of bytes from where a stream is to its end (leaving it where it was)
+static u64 bytes_left(istream& in)
+{
+    istream::pos_type start = in.tellg();
+    in.seekg(0, istream::end);
+    istream::pos_type stop = in.tellg();
+    in.clear();
+    in.seekg(start);
+    return start < 0 || stop < start ? 0 : u64(stop - start);
+}
+
+/**
+ * Checks the sizes in a header against the bytes that follow it: the columns must take up exactly
+ * those bytes, and be large enough to hold the number of records (each record takes at least a byte
+ * of the name lengths and the homework blocks, two of the exam grades, and exactly 8 of the grades).
+ **/
+static bool header_fits(const Roster_bin_header& h, u64 available)
+{
+    const u64 columns[] = { h.length_bytes, h.name_bytes, h.exam_bytes, h.hw_bytes, h.grade_bytes };
+    u64 rest = available;
+    if (h.grade_bytes % sizeof(double) != 0 || h.grade_bytes / sizeof(double) != h.count)
+        return false;
+    for (int i = 0; i != 5; ++i) {
+        if (columns[i] > rest)
+            return false;
+        rest -= columns[i];
+    }
+    return rest == 0 && h.count <= h.length_bytes && h.count <= h.exam_bytes / 2 && h.count <= h.hw_bytes;
+}
+
+// marks a stream as failed, for a roster that could not be read
+static bool roster_failed(istream& in)
+{
+    in.setstate(istream::failbit);
+    return false;
+}
+
+bool read_roster_bin(istream& in, vector<Student_info>& students, string::size_type& maxlen)
+{
+    Profile_scope timer("read_roster_bin");
+    Roster_bin_header h;
+    u64 available = bytes_left(in);
+    if (available < sizeof(h) || !in.read(reinterpret_cast<char*>(&h), sizeof(h)) ||
+        memcmp(h.magic, roster_bin_magic, 4) != 0 || h.version != roster_bin_version ||
+        !header_fits(h, available - sizeof(h)))
+        return roster_failed(in);
+
+    // (every column is known to fit in the file now, so none can ask for more memory than that)
+    vector<unsigned char> lengths, exams, hw;
+    vector<char> names;
+    vector<double> grades;
+    if (!read_column(in, lengths, h.length_bytes) || !read_column(in, names, h.name_bytes) ||
+        !read_column(in, exams, h.exam_bytes) || !read_column(in, hw, h.hw_bytes) ||
+        !read_column(in, grades, h.count))
+        return roster_failed(in);
+
+    // decode the records straight into the columns of a table, checking every column ends exactly
+    // where its last record does.
+    const unsigned char* lp = lengths.data(), * const l_end = lp + lengths.size();
+    const unsigned char* ep = exams.data(), * const e_end = ep + exams.size();
+    const unsigned char* hp = hw.data(), * const h_end = hp + hw.size();
+    u64 name_pos = 0;
+    string::size_type longest = maxlen;
+
+    // (a homework block takes about a byte per grade, which is close enough for a reservation)
+    Student_table table;
+    table.reserve(h.count, h.hw_bytes, h.name_bytes);
+    vector<int> row_hw;
+    for (u64 i = 0; i != h.count; ++i) {
+        unsigned len, mid, fin;
+        if (!(lp = read_varint(lp, l_end, len)) || len > h.name_bytes - name_pos ||
+            !(ep = read_varint(ep, e_end, mid)) || !(ep = read_varint(ep, e_end, fin)) ||
+            !(hp = unpack_homework(hp, h_end, row_hw)))
+            return roster_failed(in);
+
+        const int* hw_b = row_hw.empty() ? 0 : &row_hw[0];
+        table.push_back(names.data() + name_pos, len, unzigzag(mid), unzigzag(fin), hw_b, hw_b + row_hw.size());
+        name_pos += len;
+        longest = max(longest, string::size_type(len));
+    }
+    if (lp != l_end || name_pos != h.name_bytes || ep != e_end || hp != h_end)
+        return roster_failed(in);
+
+    // take the grades as they were stored, then add the rows as records.
+    table.assign_grades(grades.data());
+    table.to_records(students);
+    maxlen = longest;
+    profile_count("records read", h.count);
+    return true;
+}
@@ -0,0 +1,78 @@
+#ifndef GUARD_Roster_bin_h
+#define GUARD_Roster_bin_h
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Student_info.h"
+#include "Student_table.h"
+
+/**
+ * ===========================
+ * BINARY (COLUMNAR) ROSTER FILE
+ * ===========================
+ * A compact alternative to the text roster format (name midterm final hw...), so that
+ * a class file only has to be tokenised once, by the converter, rather than on every run.
+ *
+ * Rather than storing one record after the other (as the text format does), each field of
+ * every record is stored together in its own "column", one after the other:
+ *
+ *  | header | name lengths | name heap | exams | hw blocks | grades |
+ *
+ *  header       - the magic bytes "SRB1", a version number, the number of records, and the size
+ *                 (in bytes) of each column below.
+ *  name lengths - the length of each name, as a varint (see write_varint()).
+ *  name heap    - every name, one after the other (NOT null-terminated).
+ *  exams        - the midterm and final grades of each student, each as a zigzag-encoded varint.
+ *  hw blocks    - each student's homework grades, delta and bit-packed (see pack_homework()).
+ *  grades       - each student's final grade, as worked out when the roster was converted (a double,
+ *                 or 0 for a student without homework).
+ *
+ * The lengths, exam grades and homework blocks mostly take a byte or less per number, where the text
+ * format takes two or three characters and a space, so a binary roster is smaller than the text it
+ * was converted from, even with 8 bytes of final grade per record. Storing the final grades means
+ * that loading a roster does no grading at all: the homework medians (the slowest part of grading)
+ * were selected once, by the converter. (A roster therefore holds the grades of the scheme it was
+ * converted under, and should be converted again if the scheme changes.)
+ *
+ * A roster is checked as it is loaded: the sizes in the header must add up to the size of the file,
+ * and every column must hold exactly the records the header says, so a truncated or corrupt file is
+ * rejected rather than read (or allowed to ask for more memory than the file could fill).
+ *
+ * (The header is written in the byte order of the machine that wrote it.)
+ **/
+
+// the first bytes of every binary roster file, used to tell it apart from a text roster.
+extern const char roster_bin_magic[4];
+
+/**
+ * Writes a table of student records, which must already have been graded (see
+ * Student_table::grade_all()), to an output stream opened in binary mode, in the binary roster format.
+ **/
+void write_roster_bin(std::ostream&, const Student_table&);
+
+/**
+ * Checks whether the input stream is at the start of a binary roster file, without
+ * consuming any of it.
+ **/
+bool is_roster_bin(std::istream&);
+
+/**
+ * Reads an entire binary roster file from an input stream, decoding it straight into the columns of
+ * a Student_table (with the grades stored in the file) and adding a Student_info to the end of the
+ * vector for each record, and updating the length of the longest name seen so far. Returns false (with the stream marked as failed, and no records added) if the file
+ * is truncated, corrupt, or not a roster of this version.
+ **/
+bool read_roster_bin(std::istream&, std::vector<Student_info>&, std::string::size_type&);
+
+/**
+ * Appends the delta/bit-packed form of a sequence of homework grades to a vector of bytes,
+ * and does the opposite, reading a block from [p, end). unpack_homework() returns a pointer to
+ * one-past the block it read, or 0 if the block is not a valid one, or runs past the end.
+ **/
+void pack_homework(const std::vector<int>&, std::vector<unsigned char>&);
+const unsigned char* unpack_homework(const unsigned char* p, const unsigned char* end, std::vector<int>&);
+
+#endif
@@ -0,0 +1,210 @@
+#include <algorithm>
+using std::max;
+using std::min;
+
+#include <cmath>
+using std::exp;
+using std::pow;
+
+#include <cstddef>
+using std::size_t;
+
+#include <iostream>
+using std::ostream;
+
+#include <string>
+using std::string;
+
+#include <thread>
+using std::thread;
+
+#include <vector>
+using std::vector;
+
+#include "Roster_gen.h"
+
+typedef unsigned long long u64;
+
+// the number of records in each block, made by one thread at a time
+static const u64 block_records = 1 << 15;
+
+/**
+ * A small, fast random number generator ("splitmix64"), each of whose numbers only depends on its
+ * starting state and how many numbers came before it.
+ **/
+class Record_random {
+public:
+    explicit Record_random(u64 s): state(s) { }
+
+    u64 next()
+    {
+        u64 z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    // a number from 0 up to (not including) 1
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+    // a whole number from lo to hi (both included)
+    int between(int lo, int hi) { return lo + int(next() % u64(hi - lo + 1)); }
+
+private:
+    u64 state;
+};
+
+// the random numbers of a record (or the name of one, with the second argument 1)
+static Record_random record_random(u64 seed, u64 i, u64 stream = 0)
+{
+    Record_random r(seed ^ (i * 0xd1b54a32d192ed03ULL) ^ (stream * 0x8cb92ba72f3d8dd7ULL));
+    r.next();
+    return r;
+}
+
+/**
+ * The grade given by each 16-bit random number (so a single random number gives four grades).
+ * A grade is 101 * u^exponent, for u from 0 to 1 (an exponent below 1 making high grades more likely),
+ * worked out once for each of the 65536 values of u rather than for every grade.
+ **/
+class Grade_table {
+public:
+    explicit Grade_table(double skew): grades(1 << 16)
+    {
+        const double exponent = exp(-skew / 25);
+        for (size_t u = 0; u != grades.size(); ++u)
+            grades[u] = (unsigned char) min(100, int(101 * pow((u + 0.5) / grades.size(), exponent)));
+    }
+    int operator()(u64 bits) const { return grades[bits & 0xffff]; }
+
+private:
+    vector<unsigned char> grades;
+};
+
+// writes the name of record i (which only depends on the seed and i), returning the end of it
+static char* write_name(char* p, const Roster_gen_options& opts, u64 i)
+{
+    Record_random r = record_random(opts.seed, i, 1);
+    int len = r.between(opts.name_min, opts.name_max);
+    // (each random number gives 13 letters)
+    u64 bits = 0;
+    for (int k = 0; k != len; ++k) {
+        if (k % 13 == 0)
+            bits = r.next();
+        *p++ = char('a' + bits % 26);
+        bits /= 26;
+    }
+    return p;
+}
+
+// writes a space and a grade from 0 to 100, returning the end of it
+static char* write_grade(char* p, int g)
+{
+    *p++ = ' ';
+    if (g == 100) {
+        *p++ = '1';
+        *p++ = '0';
+        *p++ = '0';
+    }
+    else if (g >= 10) {
+        *p++ = char('0' + g / 10);
+        *p++ = char('0' + g % 10);
+    }
+    else
+        *p++ = char('0' + g);
+    return p;
+}
+
+// makes the records [first, last), one line each, into a block
+static void make_block(string& out, const Roster_gen_options& opts, const Grade_table& grade, u64 first, u64 last)
+{
+    // (the longest a line can be: the name, and a space and three digits for each grade, and the newline)
+    const size_t longest = opts.name_max + 4 * (2 + opts.hw_max) + 1;
+    out.resize((last - first) * longest);
+    char* p = &out[0];
+
+    for (u64 i = first; i != last; ++i) {
+        Record_random r = record_random(opts.seed, i);
+
+        // the name, either its own or that of an earlier record
+        if (i != 0 && r.uniform() < opts.duplicate_rate)
+            p = write_name(p, opts, r.next() % i);
+        else
+            p = write_name(p, opts, i);
+
+        int hw = r.uniform() < opts.missing_rate ? 0 : r.between(opts.hw_min, opts.hw_max);
+
+        // the midterm, final and homework grades, four from each random number
+        u64 bits = r.next();
+        p = write_grade(p, grade(bits));
+        p = write_grade(p, grade(bits >> 16));
+        for (int k = 2; k != hw + 2; ++k) {
+            if (k % 4 == 0)
+                bits = r.next();
+            p = write_grade(p, grade(bits >> (16 * (k % 4))));
+        }
+        *p++ = '\n';
+    }
+    out.resize(p - &out[0]);
+}
+
+// makes the blocks [first, last) of a round, on as many threads as asked for
+static void make_round(vector<string>& blocks, const Roster_gen_options& opts, const Grade_table& grade,
+                       u64 first, u64 last, unsigned threads)
+{
+    const u64 n = last - first;
+    blocks.resize(n);
+
+    vector<thread> workers;
+    for (unsigned t = 0; t < threads && t < n; ++t) {
+        workers.push_back(thread([&, t]() {
+            // (the blocks are dealt out to the threads in turn)
+            for (u64 b = t; b < n; b += threads) {
+                u64 begin = (first + b) * block_records;
+                make_block(blocks[b], opts, grade, begin, min(opts.count, begin + block_records));
+            }
+        }));
+    }
+    for (vector<thread>::iterator w = workers.begin(); w != workers.end(); ++w)
+        w->join();
+}
+
+u64 generate_roster(ostream& out, const Roster_gen_options& given)
+{
+    Roster_gen_options opts = given;
+    opts.name_min = max(1, opts.name_min);
+    opts.name_max = max(opts.name_min, opts.name_max);
+    opts.hw_min = max(0, opts.hw_min);
+    opts.hw_max = max(opts.hw_min, opts.hw_max);
+    unsigned threads = opts.threads ? opts.threads : max(1u, thread::hardware_concurrency());
+
+    // a few blocks per thread in each round, so every thread stays busy.
+    const u64 blocks = (opts.count + block_records - 1) / block_records;
+    const u64 round_blocks = 4 * u64(threads);
+
+    const Grade_table grade(opts.skew);
+    vector<string> current, next;
+    u64 bytes = 0;
+    u64 first = 0;
+    if (blocks != 0)
+        make_round(current, opts, grade, 0, min(blocks, round_blocks), threads);
+
+    while (first != blocks) {
+        u64 last = min(blocks, first + round_blocks);
+
+        // make the next round while writing this one.
+        thread maker;
+        if (last != blocks)
+            maker = thread([&]() { make_round(next, opts, grade, last, min(blocks, last + round_blocks), threads); });
+
+        for (vector<string>::const_iterator b = current.begin(); b != current.end(); ++b) {
+            out.write(b->data(), b->size());
+            bytes += b->size();
+        }
+
+        if (maker.joinable())
+            maker.join();
+        current.swap(next);
+        first = last;
+    }
+    out.flush();
+    return bytes;
+}
@@ -0,0 +1,42 @@
+#ifndef GUARD_Roster_gen_h
+#define GUARD_Roster_gen_h
+
+#include <iostream>
+
+/**
+ * =====================
+ * GENERATING A ROSTER
+ * =====================
+ * Writes a text roster of made-up records (name midterm final hw..., one record per line), of any size,
+ * to test and time the programs with. The records are made up from a SEED, so the same seed (and the
+ * same settings below) always gives exactly the same file, however many threads make it.
+ *
+ * Each record is made up from its own random numbers: those of record i only depend on the seed and
+ * i. So the records can be made in blocks, on as many threads as there are, and written in order:
+ * while the blocks of one round are written out, the threads make the blocks of the next.
+ *
+ * The settings:
+ *  - the number of records,
+ *  - the shortest and longest names (each name's length is equally likely to be any in between,
+ *    and its letters are lower case),
+ *  - the fewest and most homework grades of a record (equally likely to be any number in between),
+ *  - the share of records with no homework at all (the "missing rate", from 0 to 1),
+ *  - the share of records that take the name of an earlier record (the "duplicate rate", from 0 to 1),
+ *  - the SKEW of the grades (0 to 100): with a skew of 0, every grade is equally likely; the higher the
+ *    skew, the more likely the high grades are (and the lower below 0, the more likely the low grades).
+ **/
+struct Roster_gen_options {
+    unsigned long long count, seed;
+    int name_min, name_max;
+    int hw_min, hw_max;
+    double missing_rate, duplicate_rate, skew;
+    unsigned threads;           // (0 for one per core)
+
+    Roster_gen_options(): count(1000), seed(12345), name_min(3), name_max(12), hw_min(1), hw_max(12),
+        missing_rate(0.02), duplicate_rate(0), skew(0), threads(0) { }
+};
+
+// writes a roster of made-up records to the stream, returning the number of bytes written
+unsigned long long generate_roster(std::ostream&, const Roster_gen_options&);
+
+#endif
@@ -0,0 +1,220 @@
+#include <cstdio>
+using std::remove;
+
+#include <functional>
+using std::ref;
+
+#include <fstream>
+using std::ifstream;
+using std::ofstream;
+
+#include <iostream>
+using std::cin;
+using std::cout;
+using std::endl;
+using std::istream;
+using std::ostream;
+
+#include <sstream>
+using std::istringstream;
+
+#include <string>
+using std::getline;
+using std::string;
+
+#include <thread>
+using std::thread;
+
+#include <vector>
+using std::vector;
+
+#include "Option.h"
+#include "Pipeline.h"
+#include "Profile.h"
+#include "Roster_bin.h"
+#include "Stream.h"
+#include "Student_info.h"
+
+
+// ========================== Report_writer ==========================
+
+Report_writer::Report_writer(ostream& os, grades_funct f, str_sz len, const string& tmp):
+    out(os), passfail(f == output_records_passfail), maxlen(len), fail_path(tmp),
+    rows(os, len), fail_rows(fails, len)
+{
+    if (passfail) {
+        out << "\n--- STUDENTS WHO PASSED ---" << endl;
+        fails.open(fail_path.c_str());
+    }
+    border = write_report_header(out, maxlen);
+}
+
+Report_writer::~Report_writer()
+{
+    // make sure the temporary file is never left behind.
+    if (passfail) {
+        fails.close();
+        remove(fail_path.c_str());
+    }
+}
+
+void Report_writer::write(v_iter b, v_iter e)
+{
+    Profile_scope timer("write_batch");
+    for (; b != e; ++b) {
+        // failing records are held back until the passing table is finished.
+        if (passfail && fgrade(*b))
+            fail_rows.row(*b, false);
+        else
+            rows.row(*b, true);
+    }
+}
+
+void Report_writer::finish()
+{
+    rows.line(border);
+    rows.flush();
+
+    if (passfail) {
+        out << "\n--- STUDENTS WHO FAILED ---" << endl;
+        write_report_header(out, maxlen);
+
+        // copy the failing rows back from the temporary file (failing the output if any were lost).
+        fail_rows.flush();
+        bool held_ok = bool(fails);
+        fails.close();
+        ifstream held(fail_path.c_str());
+        if (!held_ok || !held)
+            out.setstate(std::ios::failbit);
+        else if (held.peek() != EOF)
+            out << held.rdbuf();
+
+        out << border << endl;
+    }
+}
+
+// ========================== The pipeline ==========================
+
+// the types of the batches passed between each stage
+typedef vector<string> Line_batch;
+typedef vector<Student_record> Record_batch;
+typedef vector<Student_info> Student_batch;
+
+/**
+ * The body of the reader stage: reads up to a batch of lines, moving on through the input
+ * files as each one runs out. Returns false once every file has been read.
+ **/
+class Line_reader {
+public:
+    Line_reader(const vector<string>& f, size_t n): files(f), next(0), batch_size(n), failed(0) {
+        open_next();
+    }
+
+    bool operator()(Line_batch& batch) {
+        string line;
+        while (batch.size() < batch_size && in) {
+            if (getline(*in, line))
+                batch.push_back(line);
+            else
+                open_next();
+        }
+        return in != 0;
+    }
+
+    // the number of files that could not be opened
+    int fail_count() const { return failed; }
+
+private:
+    const vector<string>& files;
+    vector<string>::size_type next;
+    size_t batch_size;
+    int failed;
+
+    ifstream file;
+    istream* in;
+
+    // move on to the next file that can be opened (or the standard input if there are no files)
+    void open_next() {
+        in = 0;
+        if (files.empty() && next == 0) {
+            ++next;
+            in = &cin;
+            return;
+        }
+        while (next < files.size()) {
+            file.close();
+            file.clear();
+            file.open(files[next].c_str());
+            if (file && !is_roster_bin(file)) {
+                ++next;
+                in = &file;
+                return;
+            }
+            // (a binary roster has no lines to stream, so it counts as a file that could not be read)
+            if (file)
+                cout << "Could not stream \'" << files[next++] << "\': binary rosters can only be read in the usual mode." << endl;
+            else
+                cout << "Could not open \'" << files[next++] << "\'." << endl;
+            ++failed;
+        }
+    }
+};
+
+// the body of the parser stage
+void parse_lines(Line_batch& lines, Record_batch& records)
+{
+    Profile_scope timer("parse_lines");
+    // join the lines back up, so the records can be read as usual.
+    string text;
+    for (Line_batch::const_iterator l = lines.begin(); l != lines.end(); ++l) {
+        text += *l;
+        text += '\n';
+    }
+
+    istringstream in(text);
+    Student_record rec;
+    while (read_record(in, rec))
+        records.push_back(rec);
+    profile_count("records read", records.size());
+}
+
+// the body of the grader stage
+void grade_records(Record_batch& records, Student_batch& students)
+{
+    Profile_scope timer("grade_records");
+    students.reserve(records.size());
+    for (Record_batch::const_iterator r = records.begin(); r != records.end(); ++r)
+        students.push_back(Student_info(*r));
+}
+
+int stream_records(const vector<string>& files, const string& out_path, const Option& opt,
+                   size_t depth, size_t batch_size, vector<Stage_stats>& stats)
+{
+    stats.clear();
+    stats.push_back(Stage_stats("reader"));
+    stats.push_back(Stage_stats("parser"));
+    stats.push_back(Stage_stats("grader"));
+    stats.push_back(Stage_stats("writer"));
+
+    Bounded_queue<Line_batch> lines(depth);
+    Bounded_queue<Record_batch> records(depth);
+    Bounded_queue<Student_batch> students(depth);
+
+    ofstream out(out_path.c_str());
+    Report_writer writer(out, opt.f, 0, out_path + ".fails.tmp");
+    Line_reader reader(files, batch_size);
+
+    // start a thread for each of the first three stages, with the writer on this thread.
+    thread t1([&]() { run_source(ref(reader), lines, stats[0]); });
+    thread t2([&]() { run_stage(lines, parse_lines, records, stats[1]); });
+    thread t3([&]() { run_stage(records, grade_records, students, stats[2]); });
+
+    run_sink(students, [&](Student_batch& b) { writer.write(b.begin(), b.end()); }, stats[3]);
+
+    t1.join();
+    t2.join();
+    t3.join();
+
+    writer.finish();
+    return reader.fail_count();
+}
@@ -0,0 +1,75 @@
+#ifndef GUARD_Stream_h
+#define GUARD_Stream_h
+
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Option.h"
+#include "Pipeline.h"
+#include "Student_info.h"
+
+/**
+ * Writes the report of an output option a batch of records at a time, rather than needing
+ * every record up front (as the grades_funct functions do). The tables are written in the same
+ * layout, but the records appear in the order they are given.
+ *
+ * For the "PASS + FAIL" option, the failing records are kept in a temporary file until
+ * finish() is called, since their table comes after every passing record.
+ **/
+class Report_writer {
+public:
+    // the output stream, the output option, the padding factor, and a path for the temporary file.
+    Report_writer(std::ostream&, grades_funct, str_sz, const std::string&);
+    ~Report_writer();
+
+    // writes the rows of a sequence of records
+    void write(v_iter, v_iter);
+    // writes the rest of the report, once there are no more records (failing the output stream if
+    // the failing rows could not be held in the temporary file).
+    void finish();
+
+private:
+    std::ostream& out;
+    bool passfail;
+    str_sz maxlen;
+    std::string border;
+
+    std::string fail_path;
+    std::ofstream fails;
+
+    // the rows of the passing (or all) records, and of the failing records (see Row_formatter)
+    Row_formatter rows, fail_rows;
+
+    // (copying a writer would make no sense)
+    Report_writer(const Report_writer&);
+    Report_writer& operator=(const Report_writer&);
+};
+
+/**
+ * ==============
+ * STREAMING MODE
+ * ==============
+ * Reads, grades and writes student records through a four-stage pipeline (see Pipeline.h):
+ *
+ *  reader -> parser -> grader -> writer
+ *
+ *  reader - reads batches of lines from the input files (or the standard input if there are none)
+ *  parser - turns each batch of lines into raw records, using read_record()
+ *  grader - grades each raw record into a Student_info
+ *  writer - writes the rows of each batch through a Report_writer
+ *
+ * Since the records are never all kept in memory, they are written in the order they were read
+ * (rather than alphabetically), and the names are padded to a fixed width. At most 'depth' batches
+ * of 'batch_size' lines are waiting between any two stages.
+ *
+ * Only text rosters can be streamed (a binary roster is reported, and skipped). Returns the number
+ * of input files that could not be opened or streamed,
+ * with the counters of each stage written to 'stats'.
+ **/
+int stream_records(const std::vector<std::string>& files, const std::string& out_path, const Option&,
+                   std::size_t depth, std::size_t batch_size, std::vector<Stage_stats>& stats);
+
+#endif
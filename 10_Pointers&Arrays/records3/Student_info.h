@@ -6,6 +6,12 @@
 #include <string>
 #include <vector>
 
+#include "Grade_bands.h"
+#include "Profile.h"
+
+// (defined below, but needed by one of the Student_info constructors)
+struct Student_record;
+
 // class for representing student records
 class Student_info {
     /**
@@ -34,27 +40,54 @@ public:
     Student_info();
     // initialise directly from user input                
     Student_info(std::istream&);
+    // initialise from an already-graded record (e.g. one loaded from a binary roster file)
+    Student_info(const std::string&, double, bool);
+    // initialise by grading a raw record (see Student_record below)
+    explicit Student_info(const Student_record&);
 
     // ----------------------------------- (Public) member functions ------------------------
     // (The const keyword is used to guarantee that no data members are changed by the grade() function.)
 
     // ------ "Getter" functions ------
-    // get student's name                  
-    std::string name() const {return n;}
+    // get student's name (a reference to it, so that no copy of the name is made)
+    const std::string& name() const {return n;}
     // check whether this record is "vaild" for use
     bool valid() const {return v;}
 
     // ----- "Method" functions ------
     // get student's (final) grade (will be slightly more than a simple "getter" function)
     double grade() const;
-    // calculates the letter grade of the student based on their final grade
-    std::string letter_grade() const;
+    // finds the letter grade of the student based on their final grade (a static string, see Grade_bands.h)
+    const char* letter_grade() const;
     // interpret user's input to initialise the Student_info object
     std::istream& read(std::istream&);
 };
 
 // --- (Note these this functions are OUTSIDE the class) ---
 
+/**
+ * The "raw" scores of a single student, exactly as they appear in a line of a text roster
+ * (unlike Student_info, which only keeps the final grade once it has been calculated).
+ **/
+struct Student_record {
+    std::string name;
+    int midterm, final;
+    std::vector<int> homework;
+};
+
+// read a single raw record (name, midterm and final exam grades, homework grades) from an input stream
+std::istream& read_record(std::istream&, Student_record&);
+
+// compute a student's overall grade from midterm and final exam grades and homework grade
+double grade(int, int, double);
+
+// the letter grade bands, and the letter grade of a final grade (see Grade_bands.h)
+extern const Band_table letter_bands;
+const char* letter_grade(double);
+
+// a roster of records, given as the range [b, e) of a vector (positions in it count from b)
+typedef std::vector<Student_info>::const_iterator roster_iter;
+
 // used to determine how two student records should be ordered
 bool compare(const Student_info&, const Student_info&);
 
@@ -73,6 +106,7 @@ bool fgrade(const Student_info&);
 template<class Fwd>
 Fwd extract_fails(Fwd b, Fwd e)
 {
+    Profile_scope timer("extract_fails");
     return stable_partition(b, e, fgrade);
 }
 
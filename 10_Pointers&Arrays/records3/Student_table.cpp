@@ -0,0 +1,191 @@
+#include <cstddef>
+using std::size_t;
+
+#include <string>
+using std::string;
+
+#include <utility>
+using std::move;
+
+#include <vector>
+using std::vector;
+
+#if defined(__SSE2__)
+#include <emmintrin.h>      // SSE2 intrinsics (2 doubles at a time)
+#endif
+
+#include "Grader.h"
+#include "order_stats.h"
+#include "Profile.h"
+#include "Student_info.h"
+#include "Student_table.h"
+
+
+void Student_table::push_back(const Student_record& rec)
+{
+    const int* hw_b = rec.homework.empty() ? 0 : &rec.homework[0];
+    push_back(rec.name.data(), rec.name.size(), rec.midterm, rec.final, hw_b, hw_b + rec.homework.size());
+}
+
+void Student_table::push_back(const char* name, size_type len, int midterm, int final,
+                              const int* hw_b, const int* hw_e)
+{
+    names.append(name, len);
+    name_off.push_back(names.size());
+
+    mid.push_back(midterm);
+    fin.push_back(final);
+
+    hw.insert(hw.end(), hw_b, hw_e);
+    hw_off.push_back(hw.size());
+
+    grades.push_back(0);
+    valid_flags.push_back(0);
+}
+
+void Student_table::reserve(size_type rows, size_type hw_values, size_type name_chars)
+{
+    names.reserve(name_chars);
+    name_off.reserve(rows + 1);
+    mid.reserve(rows);
+    fin.reserve(rows);
+    hw_off.reserve(rows + 1);
+    hw.reserve(hw_values);
+    grades.reserve(rows);
+    valid_flags.reserve(rows);
+}
+
+/**
+ * ===================================
+ * SIMD (SINGLE INSTRUCTION, MULTIPLE DATA)
+ * ===================================
+ * An SSE2 register (__m128d) holds two doubles, and each SSE2 instruction works on both of them
+ * at once, e.g. _mm_mul_pd multiplies two pairs of doubles in a single step.
+ *
+ * The kernel below works through the columns two rows at a time in this way, with
+ * Standard_grader::grade_all() (a plain loop) for the last row (if the number of rows is odd), or
+ * for every row on machines without SSE2. The weights are those of Standard_weights (see Grader.h),
+ * and the operations are done in the same order as Standard_grader::grade() does them, so the
+ * results are exactly the same.
+ **/
+void weighted_grades(const int* mid, const int* fin, const double* hw, double* out, size_t n)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128d w_mid = _mm_set1_pd(Standard_weights::midterm);
+    const __m128d w_fin = _mm_set1_pd(Standard_weights::final);
+    const __m128d w_hw = _mm_set1_pd(Standard_weights::homework);
+
+    for (; i + 2 <= n; i += 2) {
+        // load two ints from each exam column, and convert them to two doubles.
+        __m128d m = _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(mid + i)));
+        __m128d f = _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(fin + i)));
+        __m128d h = _mm_loadu_pd(hw + i);
+
+        __m128d g = _mm_add_pd(_mm_add_pd(_mm_mul_pd(w_mid, m), _mm_mul_pd(w_fin, f)),
+                               _mm_mul_pd(w_hw, h));
+        _mm_storeu_pd(out + i, g);
+    }
+#endif
+
+    Standard_grader::grade_all(mid + i, fin + i, hw + i, out + i, n - i);
+}
+
+void Student_table::grade_all()
+{
+    const size_type n = size();
+    if (n == 0)
+        return;
+
+    // the homework grade of each row (a median can't be vectorised, so this is row by row, but
+    // all in a single call sharing one scratch buffer)
+    for (size_type i = 0; i != n; ++i)
+        valid_flags[i] = hw_off[i] != hw_off[i + 1];
+
+    vector<double> hw_grade(n);
+    Order_stats<int> stats;
+    stats.medians(hw.empty() ? 0 : &hw[0], &hw_off[0], n, &hw_grade[0]);
+
+    weighted_grades(&mid[0], &fin[0], &hw_grade[0], &grades[0], n);
+
+    // invalid rows have no grade.
+    for (size_type i = 0; i != n; ++i) {
+        if (!valid_flags[i])
+            grades[i] = 0;
+    }
+}
+
+size_t fail_mask(const double* grades, const unsigned char* valid, unsigned char* mask, size_t n, double threshold)
+{
+    size_t i = 0, fails = 0;
+
+#if defined(__SSE2__)
+    const __m128d t = _mm_set1_pd(threshold);
+    for (; i + 2 <= n; i += 2) {
+        // compare two grades with the threshold at once, giving a bit per grade.
+        int below = _mm_movemask_pd(_mm_cmplt_pd(_mm_loadu_pd(grades + i), t));
+
+        mask[i]     = (below & 1) || !valid[i];
+        mask[i + 1] = (below & 2) || !valid[i + 1];
+        fails += mask[i] + mask[i + 1];
+    }
+#endif
+
+    for (; i < n; ++i) {
+        mask[i] = !valid[i] || grades[i] < threshold;
+        fails += mask[i];
+    }
+    return fails;
+}
+
+Student_table::size_type Student_table::fail_mask(vector<unsigned char>& mask, double threshold) const
+{
+    mask.resize(size());
+    return empty() ? 0 : ::fail_mask(&grades[0], &valid_flags[0], &mask[0], size(), threshold);
+}
+
+vector<Student_info>::iterator partition_fails(vector<Student_info>::iterator b, vector<Student_info>::iterator e)
+{
+    Profile_scope timer("partition_fails");
+    const size_t n = e - b;
+    if (n == 0)
+        return b;
+
+    // gather the two columns the kernel needs (an invalid record has no grade to read).
+    vector<double> grades(n);
+    vector<unsigned char> valid(n), mask(n);
+    for (size_t i = 0; i != n; ++i) {
+        valid[i] = b[i].valid();
+        grades[i] = valid[i] ? b[i].grade() : 0;
+    }
+    size_t fails = fail_mask(&grades[0], &valid[0], &mask[0], n);
+
+    // move the fails up to the front in order, holding the passes aside until they go after them.
+    vector<Student_info> passes;
+    passes.reserve(n - fails);
+    // (a fail already in its place, before any pass, is left where it is rather than moved onto itself)
+    vector<Student_info>::iterator out = b;
+    for (size_t i = 0; i != n; ++i) {
+        if (!mask[i])
+            passes.push_back(move(b[i]));
+        else if (out++ != b + i)
+            *(out - 1) = move(b[i]);
+    }
+    return move(passes.begin(), passes.end(), out) - passes.size();
+}
+
+void Student_table::assign_grades(const double* g)
+{
+    for (size_type i = 0; i != size(); ++i) {
+        valid_flags[i] = hw_off[i] != hw_off[i + 1];
+        grades[i] = valid_flags[i] ? g[i] : 0;
+    }
+}
+
+void Student_table::to_records(vector<Student_info>& students) const
+{
+    students.reserve(students.size() + size());
+    for (size_type i = 0; i != size(); ++i)
+        students.push_back((*this)[i]);
+}
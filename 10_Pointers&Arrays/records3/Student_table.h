@@ -0,0 +1,126 @@
+#ifndef GUARD_Student_table_h
+#define GUARD_Student_table_h
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Student_info.h"
+
+/**
+ * =========================
+ * A COLUMN STORE OF RECORDS
+ * =========================
+ * A vector<Student_info> keeps each record's fields together (an "array of structures"), so
+ * looking at only the grades of every record still means stepping over every name in memory.
+ *
+ * Student_table instead keeps each field of every record in a column of its own (a "structure of
+ * arrays"): a name heap with offsets, midterms, finals, homework offsets and values, grades and
+ * valid flags. A scan over the grades then only touches the grade column, and loops over the
+ * numeric columns can be vectorised, that is, carried out on several rows at once with SIMD
+ * instructions (see grade_all() and fail_mask()). A text roster is graded this way when it is converted to a binary
+ * roster (see Roster_bin.h), giving exactly the grades that reading and grading its records one at a
+ * time would, and a binary roster is decoded straight into the columns of a table.
+ *
+ * Row i can still be turned into a single record through operator[], for use with the usual
+ * record functions. This is a copy rather than a view: it builds a new Student_info, copying the
+ * row's name out of the name heap, so it costs as much as any other record. Code that only needs
+ * a field or two should read them through the per-row accessors instead.
+ **/
+class Student_table {
+public:
+    typedef std::vector<double>::size_type size_type;
+
+    Student_table() : name_off(1, 0), hw_off(1, 0) { }
+
+    // the number of rows (records)
+    size_type size() const { return mid.size(); }
+    bool empty() const { return mid.empty(); }
+
+    // add a raw record as a new row (ungraded until grade_all() is called)
+    void push_back(const Student_record&);
+    // the same, from a name of len characters and the homework grades [hw_b, hw_e) (e.g. as
+    // they are decoded from a binary roster, without building a Student_record for each row)
+    void push_back(const char* name, size_type len, int midterm, int final, const int* hw_b, const int* hw_e);
+
+    // reserve space for a number of rows, a number of homework grades and name characters across them
+    void reserve(size_type rows, size_type hw_values, size_type name_chars = 0);
+
+    // ----- per-row access -----
+    std::string name(size_type i) const {
+        return std::string(names.begin() + name_off[i], names.begin() + name_off[i + 1]);
+    }
+    int midterm(size_type i) const { return mid[i]; }
+    int final(size_type i) const { return fin[i]; }
+    // the homework grades of row i are [hw_begin(i), hw_end(i))
+    const int* hw_begin(size_type i) const { return hw.empty() ? 0 : &hw[0] + hw_off[i]; }
+    const int* hw_end(size_type i) const { return hw.empty() ? 0 : &hw[0] + hw_off[i + 1]; }
+    double grade(size_type i) const { return grades[i]; }
+    bool valid(size_type i) const { return valid_flags[i] != 0; }
+
+    // row i as a single record (a new Student_info, holding a copy of the name)
+    Student_info operator[](size_type i) const { return Student_info(name(i), grades[i], valid(i)); }
+
+    // ----- whole-column operations -----
+
+    /**
+     * Grades every row at once: the median of each row's homework first, then the weighted sum
+     * 0.2 * midterm + 0.4 * final + 0.4 * homework over all the rows with a SIMD kernel.
+     * Rows without homework are marked invalid (with a grade of 0).
+     **/
+    void grade_all();
+
+    /**
+     * Takes the grade of every row from an array of size() grades (such as those stored in a
+     * binary roster) rather than working them out. Rows without homework are still marked invalid.
+     **/
+    void assign_grades(const double*);
+
+    /**
+     * Sets mask[i] to 1 if row i is a fail (invalid, or graded below the threshold), 0 otherwise,
+     * comparing several grades at a time. Returns the number of fails.
+     **/
+    size_type fail_mask(std::vector<unsigned char>& mask, double threshold = 60) const;
+
+    // adds every row, as a record, to the end of a vector of records
+    void to_records(std::vector<Student_info>&) const;
+
+    // ----- raw columns (for writing a binary roster) -----
+    const std::string& name_heap() const { return names; }
+    const std::vector<unsigned long long>& name_offsets() const { return name_off; }
+
+private:
+    std::string names;
+    std::vector<unsigned long long> name_off;   // (size() + 1) offsets into names
+    std::vector<int> mid, fin;
+    std::vector<unsigned long long> hw_off;     // (size() + 1) offsets into hw
+    std::vector<int> hw;
+    std::vector<double> grades;
+    std::vector<unsigned char> valid_flags;
+};
+
+/**
+ * The SIMD kernel behind grade_all(): out[i] = 0.2 * mid[i] + 0.4 * fin[i] + 0.4 * hw[i] (the
+ * weights of Standard_weights) for every i in [0, n). (It gives exactly the same results as
+ * Standard_grader::grade(), and so as grade(int, int, double).)
+ **/
+void weighted_grades(const int* mid, const int* fin, const double* hw, double* out, std::size_t n);
+
+/**
+ * The SIMD kernel behind fail_mask(): mask[i] = !valid[i] || grades[i] < threshold for every i
+ * in [0, n), returning the number of fails. (It gives exactly the same results as fgrade() does
+ * with a threshold of 60.)
+ **/
+std::size_t fail_mask(const double* grades, const unsigned char* valid, unsigned char* mask,
+                      std::size_t n, double threshold = 60);
+
+/**
+ * Does what extract_fails() does to the records [b, e) (moving the fails to the front, keeping
+ * the order within each part, and returning where the passes start), but finds the fails with the
+ * fail_mask() kernel: the grades and valid flags are gathered into two columns first, so the
+ * comparisons are made two at a time, and the records are then moved by the mask.
+ **/
+std::vector<Student_info>::iterator partition_fails(std::vector<Student_info>::iterator b,
+                                                    std::vector<Student_info>::iterator e);
+
+#endif
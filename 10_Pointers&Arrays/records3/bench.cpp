@@ -0,0 +1,363 @@
+#include <algorithm>
+using std::max;
+using std::sort;
+
+#include <chrono>
+
+#include <cstdlib>
+using std::atoi;
+
+#include <cstring>
+using std::memcpy;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+using std::ostream;
+
+#include <stdexcept>
+using std::domain_error;
+
+#include <streambuf>
+using std::streambuf;
+using std::streamsize;
+
+#include <string>
+using std::string;
+using std::to_string;
+
+#include <vector>
+using std::vector;
+
+#include "Grade_index.h"
+#include "Grader.h"
+#include "median.h"
+#include "Name_sort.h"
+#include "Option.h"
+#include "Student_info.h"
+
+/**
+ * Times grading the same made-up records three ways:
+ *  1) as grading used to be done: the homework grading method passed in as a function pointer
+ *     (with the homework vector copied for each call),
+ *  2) with the Standard_grader (see Grader.h), whose policies are all chosen when compiling,
+ *  3) with the "standard" scheme looked up by name in the table of grading schemes.
+ * and checks that every grade comes out exactly the same. Then times finding their letter grades,
+ * one at a time and all at once.
+ *
+ * 1st argument (optional): the number of records to grade (100000 by default)
+ **/
+typedef vector<int>::iterator iter;
+
+// the old way of grading, kept for comparison.
+double pointer_grade(int midterm, int final, vector<int> hw, double hw_grade_method(iter, iter))
+{
+    if (hw.empty())
+        throw domain_error("student has done no homework");
+    return grade(midterm, final, hw_grade_method(hw.begin(), hw.end()));
+}
+
+int bench_grading(int argc, char** argv)
+{
+    typedef std::chrono::steady_clock clock;
+    int n = argc > 0 ? atoi(argv[0]) : 100000;
+    if (n <= 0)
+        n = 100000;
+
+    // made-up records, each with between 1 and 16 homework grades (from a fixed seed, to be repeatable).
+    vector<int> mid(n), fin(n);
+    vector<vector<int> > hw(n);
+    unsigned seed = 12345;
+    for (int i = 0; i != n; ++i) {
+        seed = seed * 1103515245 + 12345;
+        mid[i] = (seed >> 8) % 101;
+        fin[i] = (seed >> 16) % 101;
+        hw[i].resize(1 + (seed >> 4) % 16);
+        for (vector<int>::size_type j = 0; j != hw[i].size(); ++j) {
+            seed = seed * 1103515245 + 12345;
+            hw[i][j] = (seed >> 8) % 101;
+        }
+    }
+
+    const Grading_scheme* standard = find_grading_scheme("standard");
+    vector<double> by_pointer(n), by_policy(n), by_table(n);
+
+    clock::time_point t0 = clock::now();
+    for (int i = 0; i != n; ++i)
+        by_pointer[i] = pointer_grade(mid[i], fin[i], hw[i], median<int, iter>);
+    clock::time_point t1 = clock::now();
+    for (int i = 0; i != n; ++i)
+        by_policy[i] = Standard_grader::grade(mid[i], fin[i], hw[i].begin(), hw[i].end());
+    clock::time_point t2 = clock::now();
+    for (int i = 0; i != n; ++i) {
+        const int* b = hw[i].data();
+        by_table[i] = standard->grade(mid[i], fin[i], b, b + hw[i].size());
+    }
+    clock::time_point t3 = clock::now();
+
+    typedef std::chrono::duration<double, std::milli> ms;
+    cout << "Grading " << n << " records:" << endl;
+    cout << "  function pointer:  " << ms(t1 - t0).count() << " ms" << endl;
+    cout << "  Standard_grader:   " << ms(t2 - t1).count() << " ms" << endl;
+    cout << "  scheme table:      " << ms(t3 - t2).count() << " ms" << endl;
+
+    bool same = by_pointer == by_policy && by_pointer == by_table;
+    cout << (same ? "All grades identical." : "GRADES DIFFER!") << endl;
+
+    // the letter grades too: one grade at a time, and the whole column of grades at once (see Grade_bands.h)
+    vector<const char*> letters(n);
+    vector<Band_table::code_type> codes(n);
+    clock::time_point t4 = clock::now();
+    for (int i = 0; i != n; ++i)
+        letters[i] = letter_grade(by_policy[i]);
+    clock::time_point t5 = clock::now();
+    letter_bands.codes(&by_policy[0], n, &codes[0]);
+    clock::time_point t6 = clock::now();
+
+    cout << "Letter grades of " << n << " records:" << endl;
+    cout << "  one at a time:     " << ms(t5 - t4).count() << " ms" << endl;
+    cout << "  whole column:      " << ms(t6 - t5).count() << " ms" << endl;
+
+    for (int i = 0; i != n; ++i)
+        same = same && letters[i] == letter_bands.name(codes[i]);
+    cout << (same ? "All letter grades identical." : "LETTER GRADES DIFFER!") << endl;
+    return same ? 0 : 1;
+}
+
+/**
+ * A stream buffer that throws away everything written to it, keeping only a count and a hash of the
+ * bytes, so that two ways of writing the same output can be timed and compared without a file.
+ * (The bytes are hashed 8 at a time, carrying any left over to the next write, so the hash is the same
+ * however the output is split up into writes.)
+ **/
+class Hash_buffer: public streambuf {
+public:
+    Hash_buffer(): bytes(0), hash(14695981039346656037ULL), word(0) { }
+    unsigned long long bytes, hash;
+
+    // the hash of everything written (including any last, unfinished word)
+    unsigned long long digest() const { return (hash ^ word) * 1099511628211ULL; }
+protected:
+    int overflow(int c) {
+        if (c != EOF) {
+            char ch = char(c);
+            xsputn(&ch, 1);
+        }
+        return c;
+    }
+    streamsize xsputn(const char* s, streamsize n) {
+        streamsize i = 0;
+        // finish the word left over from the last write, then take whole words, then start a new one.
+        for (; i != n && bytes % 8 != 0; ++i)
+            add(s[i]);
+        for (; n - i >= 8; i += 8) {
+            unsigned long long w;
+            memcpy(&w, s + i, 8);
+            hash = (hash ^ w) * 1099511628211ULL;
+            bytes += 8;
+        }
+        for (; i != n; ++i)
+            add(s[i]);
+        return n;
+    }
+private:
+    unsigned long long word;
+    void add(char c) {
+        word |= (unsigned long long) (unsigned char) c << (8 * (bytes % 8));
+        if (++bytes % 8 == 0) {
+            hash = (hash ^ word) * 1099511628211ULL;
+            word = 0;
+        }
+    }
+};
+
+/**
+ * Times writing the "ALL" report of made-up records, first row by row through the stream (using
+ * write_report_row(), as the report used to be written), and then with output_records_std() (which
+ * uses a Row_formatter), and checks that both write exactly the same bytes.
+ *
+ * 1st argument (optional): the number of records (1000000 by default)
+ **/
+int bench_output(int argc, char** argv)
+{
+    typedef std::chrono::steady_clock clock;
+    typedef std::chrono::duration<double, std::milli> ms;
+    int n = argc > 0 ? atoi(argv[0]) : 1000000;
+    if (n <= 0)
+        n = 1000000;
+
+    // made-up records, some without homework (from a fixed seed, to be repeatable).
+    vector<Student_info> students;
+    students.reserve(n);
+    unsigned seed = 12345;
+    str_sz maxlen = 0;
+    for (int i = 0; i != n; ++i) {
+        seed = seed * 1103515245 + 12345;
+        string name = "student" + to_string(seed % 1000003);
+        maxlen = max(maxlen, name.size());
+        students.push_back(Student_info(name, (seed >> 8) % 1001 / 10.0, (seed >> 4) % 50 != 0));
+    }
+
+    Hash_buffer old_buf, new_buf;
+    ostream old_out(&old_buf), new_out(&new_buf);
+
+    clock::time_point t0 = clock::now();
+    string border = write_report_header(old_out, maxlen);
+    for (vector<Student_info>::const_iterator it = students.begin(); it != students.end(); ++it)
+        write_report_row(old_out, *it, maxlen, true);
+    old_out << border << endl;
+    clock::time_point t1 = clock::now();
+    output_records_std(new_out, students.begin(), students.end(), maxlen);
+    clock::time_point t2 = clock::now();
+
+    cout << "Writing " << n << " rows (" << new_buf.bytes << " bytes):" << endl;
+    cout << "  row by row:        " << ms(t1 - t0).count() << " ms" << endl;
+    cout << "  Row_formatter:     " << ms(t2 - t1).count() << " ms" << endl;
+
+    bool same = old_buf.bytes == new_buf.bytes && old_buf.digest() == new_buf.digest();
+    cout << (same ? "Output identical." : "OUTPUT DIFFERS!") << endl;
+    return same ? 0 : 1;
+}
+
+/**
+ * Times sorting made-up records by name, with sort() (copying the names to compare them, and with
+ * compare), and with sort_by_name() (see Name_sort.h), and checks that the names come out in the same order.
+ *
+ * 1st argument (optional): the number of records (1000000 by default)
+ **/
+int bench_sort(int argc, char** argv)
+{
+    typedef std::chrono::steady_clock clock;
+    typedef std::chrono::duration<double, std::milli> ms;
+    int n = argc > 0 ? atoi(argv[0]) : 1000000;
+    if (n <= 0)
+        n = 1000000;
+
+    // made-up names of 4 to 15 letters, about half starting with a common surname (from a fixed seed).
+    static const char* const surnames[] = { "smith", "jones", "williams", "taylor", "brown", "davies" };
+    vector<Student_info> students;
+    students.reserve(n);
+    unsigned seed = 12345;
+    for (int i = 0; i != n; ++i) {
+        seed = seed * 1103515245 + 12345;
+        string name = (seed >> 16) % 2 ? surnames[(seed >> 8) % 6] : "";
+        int letters = 4 + (seed >> 4) % 12;
+        for (int j = 0; j != letters; ++j) {
+            seed = seed * 1103515245 + 12345;
+            name += char('a' + (seed >> 16) % 26);
+        }
+        students.push_back(Student_info(name, (seed >> 8) % 1001 / 10.0, true));
+    }
+    vector<Student_info> copy = students, by_value = students;
+
+    // (as compare() used to be, when name() returned a copy of the name)
+    clock::time_point t0 = clock::now();
+    sort(by_value.begin(), by_value.end(), [](const Student_info& x, const Student_info& y) {
+        return string(x.name()) < string(y.name());
+    });
+    clock::time_point t1 = clock::now();
+    sort(copy.begin(), copy.end(), compare);
+    clock::time_point t2 = clock::now();
+    sort_by_name(students);
+    clock::time_point t3 = clock::now();
+
+    cout << "Sorting " << n << " records by name:" << endl;
+    cout << "  copying the names:    " << ms(t1 - t0).count() << " ms" << endl;
+    cout << "  sort() with compare:  " << ms(t2 - t1).count() << " ms" << endl;
+    cout << "  sort_by_name():       " << ms(t3 - t2).count() << " ms" << endl;
+
+    bool same = true;
+    for (int i = 0; i != n && same; ++i)
+        same = students[i].name() == copy[i].name();
+    cout << (same ? "Same order." : "ORDER DIFFERS!") << endl;
+    return same ? 0 : 1;
+}
+
+/**
+ * Times finding the number of failing students of made-up records at 100 different pass marks, by
+ * checking every record (as fgrade() does, but with each pass mark), by extract_fails() (for a pass mark
+ * of 60 only, as it is the only one it knows), and with a Grade_index (including building it), and
+ * checks that the counts are the same.
+ *
+ * 1st argument (optional): the number of records (1000000 by default)
+ **/
+int bench_thresholds(int argc, char** argv)
+{
+    typedef std::chrono::steady_clock clock;
+    typedef std::chrono::duration<double, std::milli> ms;
+    int n = argc > 0 ? atoi(argv[0]) : 1000000;
+    if (n <= 0)
+        n = 1000000;
+
+    // made-up records, one in 50 with no grade (from a fixed seed)
+    vector<Student_info> students;
+    students.reserve(n);
+    unsigned seed = 12345;
+    for (int i = 0; i != n; ++i) {
+        seed = seed * 1103515245 + 12345;
+        students.push_back(Student_info("s" + to_string(i), (seed >> 8) % 1001 / 10.0, (seed >> 4) % 50 != 0));
+    }
+    vector<Student_info> copy = students;
+    const int marks = 100;
+
+    clock::time_point t0 = clock::now();
+    vector<size_t> scanned(marks);
+    for (int m = 0; m != marks; ++m) {
+        for (vector<Student_info>::const_iterator s = students.begin(); s != students.end(); ++s)
+            scanned[m] += !s->valid() || s->grade() < m;
+    }
+    clock::time_point t1 = clock::now();
+    size_t extracted = extract_fails(copy.begin(), copy.end()) - copy.begin();
+    clock::time_point t2 = clock::now();
+    Grade_index index(students.begin(), students.end());
+    clock::time_point t3 = clock::now();
+    vector<size_t> indexed(marks);
+    for (int m = 0; m != marks; ++m)
+        indexed[m] = index.fails(m).size();
+    clock::time_point t4 = clock::now();
+
+    cout << "Counting the failing students of " << n << " records at " << marks << " pass marks:" << endl;
+    cout << "  checking every record:       " << ms(t1 - t0).count() << " ms" << endl;
+    cout << "  extract_fails() (60 only):   " << ms(t2 - t1).count() << " ms" << endl;
+    cout << "  building a Grade_index:      " << ms(t3 - t2).count() << " ms" << endl;
+    cout << "  with the Grade_index:        " << ms(t4 - t3).count() << " ms" << endl;
+
+    bool same = scanned == indexed && extracted == indexed[60];
+    cout << (same ? "Same counts." : "COUNTS DIFFER!") << endl;
+    return same ? 0 : 1;
+}
+
+/**
+ * ==============
+ * BENCHMARK MODE
+ * ==============
+ * A program of its own (so that the program that writes the reports only has the modes meant for
+ * its users), timing the ways the records can be processed, and checking they give the same results.
+ * It is built from the same files as the program, with bench.cpp in place of main.cpp, and with
+ * optimisations on since it is timings that are of interest, e.g.
+ *
+ *  g++ -pthread -O2 -o bench $(ls *.cpp | grep -v main.cpp)
+ *
+ * 1st argument: the benchmark to run ("grading", "output", "sort" or "thresholds")
+ * 2nd argument (optional): the number of records
+ **/
+int main(int argc, char** argv)
+{
+    string mode = argc > 1 ? argv[1] : "";
+
+    // time the ways of grading a record.
+    if (mode == "grading")
+        return bench_grading(argc - 2, argv + 2);
+    // or of writing a report.
+    if (mode == "output")
+        return bench_output(argc - 2, argv + 2);
+    // or of sorting the records.
+    if (mode == "sort")
+        return bench_sort(argc - 2, argv + 2);
+    // or of finding the failing students.
+    if (mode == "thresholds")
+        return bench_thresholds(argc - 2, argv + 2);
+
+    cout << "Usage: bench <grading | output | sort | thresholds> [N]" << endl;
+    return 1;
+}
@@ -1,6 +1,11 @@
-#include <algorithm>
-using std::max;
-using std::sort;
+#include <cerrno>
+
+#include <climits>
+
+#include <cstdlib>
+using std::strtod;
+using std::strtol;
+using std::strtoull;
 
 #include <fstream>
 using std::ifstream;
@@ -25,35 +30,193 @@ using std::ostream;
 #include <map>
 using std::map;
 
-#include <stdexcept>
-using std::domain_error;
-
 #include <string>
 using std::string;
 
 #include <vector>
 using std::vector;
 
+#include "External_sort.h"
+#include "Grade_cache.h"
+#include "Grader.h"
+#include "Ingest.h"
+#include "Name_sort.h"
 #include "Option.h"
 #include "pad_str.h"
+#include "Profile.h"
+#include "Roster_bin.h"
+#include "Roster_gen.h"
+#include "Stream.h"
+#include "Student_table.h"
 #include "Student_info.h"
 #include "trim.h"
 
 
 /**
- * Reads from an input stream student grade data and adds it to the end of a
- * vector. It also takes a value (by reference) representing the size of the 
- * student name read so far, in order to updated and used for padding the output
- * later.
+ * ============
+ * CONVERT MODE
+ * ============
+ * Converts one or more text rosters into a single binary roster file, so that later runs
+ * can load the records without having to parse and grade them again.
+ *
+ * 1st argument: output (binary) file
+ * Further arguments: input (text) files
+ *
+ * Returns the number of files that could not be opened.
  **/
-void read_input(istream& in, vector<Student_info>& students, string::size_type& maxlen)
-{   
-    Student_info record;
+int convert_files(int argc, char** argv)
+{
+    if (argc < 2) {
+        cout << "Usage: --convert <output file> <input file>..." << endl;
+        return 1;
+    }
+
+    Student_table table;
+    Student_record rec;
+    int fail_count = 0;
 
-    while (record.read(in)) {
-        maxlen = max(maxlen, record.name().size());
-        students.push_back(record);
+    for (int i = 1; i != argc; ++i) {
+        ifstream in_file(argv[i]);
+        if (in_file) {
+            while (read_record(in_file, rec))
+                table.push_back(rec);
+        }
+        else {
+            cout << "Could not open \'" << argv[i] << "\'." << endl;
+            ++fail_count;
+        }
     }
+
+    // grade every row at once, and write the table's columns out (grades included).
+    table.grade_all();
+    ofstream out(argv[0], std::ios::binary);
+    write_roster_bin(out, table);
+    cout << table.size() << " records written to \'" << argv[0] << "\'." << endl;
+
+    return fail_count;
+}
+
+// reads a whole argument as a number (of any kind), returning false if it is not one
+bool parse_number(const char* s, double& x)
+{
+    char* end;
+    x = strtod(s, &end);
+    return end != s && *end == '\0';
+}
+
+// reads a whole argument as a whole number that fits in an int, returning false if it is not one
+bool parse_int(const char* s, int& x)
+{
+    char* end;
+    errno = 0;
+    long n = strtol(s, &end, 10);
+    if (end == s || *end != '\0' || errno == ERANGE || n < INT_MIN || n > INT_MAX)
+        return false;
+    x = int(n);
+    return true;
+}
+
+/**
+ * =============
+ * GENERATE MODE
+ * =============
+ * Writes a text roster of made-up records, of any size (see Roster_gen.h).
+ *
+ * 1st argument: output (text) file ("-" for the standard output)
+ * 2nd argument: the number of records (which may be written like 1e6)
+ * Options (after the arguments):
+ *  --seed N                the seed the records are made up from (12345 by default)
+ *  --name-length MIN MAX   the shortest and longest names (3 and 12 by default, with 1 <= MIN <= MAX)
+ *  --homework MIN MAX      the fewest and most homework grades of a record (1 and 12 by default,
+ *                          with 0 <= MIN <= MAX)
+ *  --missing-rate P        the share of records with no homework (0.02 by default, from 0 to 1)
+ *  --duplicate-rate P      the share of records with the name of an earlier record (0 by default, from 0 to 1)
+ *  --skew S                how much more likely high grades are than low ones (0 by default)
+ *  --jobs N                the number of threads to make the records on (one per core by default, N >= 1)
+ *
+ * Any value that is not a number, or is out of its range, is rejected (with the usage message) rather
+ * than quietly changed into one that is.
+ **/
+int generate_file(int argc, char** argv)
+{
+    static const char usage[] =
+        "Usage: --generate <output file> <records> [--seed N] [--name-length MIN MAX] [--homework MIN MAX]"
+        " [--missing-rate P] [--duplicate-rate P] [--skew S] [--jobs N]";
+    if (argc < 2) {
+        cout << usage << endl;
+        return 1;
+    }
+
+    Roster_gen_options opts;
+    double count;
+    if (!parse_number(argv[1], count) || !(count >= 0 && count < 1.8e19)) {
+        cout << "The number of records must be a number, of at least 0 (not '" << argv[1] << "')." << endl;
+        cout << usage << endl;
+        return 1;
+    }
+    opts.count = (unsigned long long) count;
+
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        bool ok;
+        int jobs = 0;
+        if (arg == "--seed" && i + 1 < argc) {
+            char* end;
+            const char* s = argv[++i];
+            opts.seed = strtoull(s, &end, 10);
+            ok = end != s && *end == '\0' && s[0] != '-';
+        }
+        else if (arg == "--name-length" && i + 2 < argc) {
+            ok = parse_int(argv[i + 1], opts.name_min) && parse_int(argv[i + 2], opts.name_max) &&
+                 1 <= opts.name_min && opts.name_min <= opts.name_max;
+            i += 2;
+        }
+        else if (arg == "--homework" && i + 2 < argc) {
+            ok = parse_int(argv[i + 1], opts.hw_min) && parse_int(argv[i + 2], opts.hw_max) &&
+                 0 <= opts.hw_min && opts.hw_min <= opts.hw_max;
+            i += 2;
+        }
+        else if (arg == "--missing-rate" && i + 1 < argc)
+            ok = parse_number(argv[++i], opts.missing_rate) && opts.missing_rate >= 0 && opts.missing_rate <= 1;
+        else if (arg == "--duplicate-rate" && i + 1 < argc)
+            ok = parse_number(argv[++i], opts.duplicate_rate) && opts.duplicate_rate >= 0 && opts.duplicate_rate <= 1;
+        else if (arg == "--skew" && i + 1 < argc)
+            ok = parse_number(argv[++i], opts.skew);
+        else if (arg == "--jobs" && i + 1 < argc) {
+            ok = parse_int(argv[++i], jobs) && jobs >= 1;
+            opts.threads = jobs;
+        }
+        else {
+            cout << "Unknown option '" << arg << "'." << endl;
+            cout << usage << endl;
+            return 1;
+        }
+
+        if (!ok) {
+            cout << "Invalid value for '" << arg << "'." << endl;
+            cout << usage << endl;
+            return 1;
+        }
+    }
+
+    // (written to the standard output, nothing else may be written there)
+    if (string(argv[0]) == "-") {
+        generate_roster(cout, opts);
+        return cout ? 0 : 1;
+    }
+
+    ofstream out(argv[0], std::ios::binary);
+    if (!out) {
+        cout << "Could not open '" << argv[0] << "'." << endl;
+        return 1;
+    }
+    unsigned long long bytes = generate_roster(out, opts);
+    if (!out) {
+        cout << "Could not write '" << argv[0] << "'." << endl;
+        return 1;
+    }
+    cout << opts.count << " records (" << bytes << " bytes) written to '" << argv[0] << "'." << endl;
+    return 0;
 }
 
 /**
@@ -62,6 +225,11 @@ void read_input(istream& in, vector<Student_info>& students, string::size_type&
  * Option 1: Output records in usual way (all of them together, line by line).
  * Option 2: Output the records in two parts, one for the passing students and the other 
  *           for the failing students.
+ * Option 3: Output the top 10 students only.
+ * Option 4: Output the grades at a few percentiles, then every student in order of rank.
+ * Option 5: Answer queries about ranks, entered after choosing the option (see Rank_index.h).
+ * Option 6: Answer queries about pass marks and ranges of grades, entered after choosing the option
+ *           (see Grade_index.h).
  **/
 Option choose_option()
 {
@@ -94,6 +262,10 @@ Option choose_option()
     // Add the options to the options map
     op_map["1"] = Option("ALL", output_records_std);
     op_map["2"] = Option("PASS + FAIL", output_records_passfail);
+    op_map["3"] = Option("TOP 10", output_records_top);
+    op_map["4"] = Option("PERCENTILES", output_records_percentiles);
+    op_map["5"] = Option("RANK QUERIES", output_rank_queries);
+    op_map["6"] = Option("PASS MARKS", output_threshold_queries);
 
     // define an approprate prompt for the user to receive.
     string prompt = "How you would like to output the student records?";
@@ -103,6 +275,33 @@ Option choose_option()
 
 }
 
+/**
+ * Whether an option needs every record at once (as the ranking options do), so that it cannot be
+ * written a batch at a time in streaming mode or with a memory budget.
+ **/
+bool needs_whole_roster(const Option& opt)
+{
+    return opt.f == output_records_top || opt.f == output_records_percentiles || opt.f == output_rank_queries ||
+           opt.f == output_threshold_queries;
+}
+
+/**
+ * Checks that none of the input files is a binary roster, which can only be read in the usual mode
+ * (not streamed, nor sorted within a memory budget), naming any that is.
+ **/
+bool text_inputs_only(const vector<string>& files, const string& mode)
+{
+    bool ok = true;
+    for (vector<string>::const_iterator f = files.begin(); f != files.end(); ++f) {
+        ifstream in(f->c_str(), std::ios::binary);
+        if (in && is_roster_bin(in)) {
+            cout << "\'" << *f << "\' is a binary roster, which cannot be read with " << mode << "." << endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
 /**
  * Processes the user's option for how to output the student grades, 
  * writting the results to an output file at a given (relative) directory.
@@ -153,52 +352,168 @@ bool do_option(const string& out_dir, const Option& opt, vector<Student_info>& s
  * 1st argument: input file
  * 2nd argument: output file
  * Further arguments: extra input files
+ *
+ * (Any input file may also be a binary roster, see Roster_bin.h.
+ *  Alternatively, the first argument may be "--convert", see convert_files(), or "--generate",
+ *  see generate_file().)
+ *
+ * Options (which may appear anywhere, and are not counted as one of the arguments above):
+ *  --jobs N   read the input files in parallel on N threads (0 for one per core, at most 256),
+ *             see read_files_parallel().
+ *  --stream   read, grade and write the records through a pipeline, without keeping
+ *             them all in memory (see stream_records()).
+ *  --queue-depth N
+ *             the number of batches that may wait between two stages of the pipeline (1 to 1024).
+ *  --memory-budget N
+ *             sort and write the records while holding no more than about N megabytes
+ *             of them in memory (1 to 1048576, see sort_records_external()).
+ *  --profile  time the stages of the run, writing a summary to "profile.json" and a trace
+ *             to "profile.trace.json" (see Profile.h).
+ *  --cache FILE
+ *             keep the grades of the text records read in a cache file, so that the lines that
+ *             have not changed since the last run are not parsed and graded again (see Grade_cache.h).
+ *
+ * A value that is not a whole number, or is out of its range, is rejected (with the usage message)
+ * rather than read as whatever atoi() makes of it (e.g. "--jobs -1" asking for 4294967295 threads).
  **/
 int main(int argc, char** argv)
 {   
-    // define vector for holding all the student records read.
-    vector<Student_info> students;
-    // used to hold the current record being read from the input
-    Student_info record;
-    
-    // record the length of the longest name, for padding the output
-    string::size_type maxlen = 0;
+    static const char usage[] =
+        "Usage: <input file> <output file> [<input file>...] [--jobs N] [--stream] [--queue-depth N]"
+        " [--memory-budget N] [--profile] [--cache FILE]";
+    // the most threads, queued batches and megabytes of memory budget that may be asked for
+    const int max_jobs = 256, max_queue_depth = 1024, max_memory_budget = 1 << 20;
+
+    // run in convert mode if requested, instead of outputting grades.
+    if (argc > 1 && string(argv[1]) == "--convert")
+        return convert_files(argc - 2, argv + 2);
+    // or in generate mode, to write a roster of made-up records.
+    if (argc > 1 && string(argv[1]) == "--generate")
+        return generate_file(argc - 2, argv + 2);
+
+    // the arguments that are not options, in the order they were entered.
+    vector<string> args;
+    // the number of threads to read the input files with (-1 to read them serially)
+    int jobs = -1;
+    // whether to run in streaming mode, and the queue depth of its pipeline
+    bool streaming = false;
+    int queue_depth = 8;
+    // the memory budget (in megabytes) for sorting externally (0 to sort in memory as usual)
+    int memory_budget = 0;
+    // whether to profile the run
+    bool profile = false;
+    // the grade cache file (none if empty)
+    string cache_path;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool ok = true;
+        if (arg == "--jobs" && i + 1 < argc)
+            ok = parse_int(argv[++i], jobs) && jobs >= 0 && jobs <= max_jobs;
+        else if (arg == "--stream")
+            streaming = true;
+        else if (arg == "--queue-depth" && i + 1 < argc)
+            ok = parse_int(argv[++i], queue_depth) && queue_depth >= 1 && queue_depth <= max_queue_depth;
+        else if (arg == "--memory-budget" && i + 1 < argc)
+            ok = parse_int(argv[++i], memory_budget) && memory_budget >= 1 && memory_budget <= max_memory_budget;
+        else if (arg == "--profile")
+            profile = true;
+        else if (arg == "--cache" && i + 1 < argc)
+            cache_path = argv[++i];
+        else
+            args.push_back(arg);
+
+        if (!ok) {
+            cout << "Invalid value for '" << arg << "'." << endl;
+            cout << usage << endl;
+            return 1;
+        }
+    }
 
-    // represents the number of files that could be opened
-    int success_count = 0;
-    // represents the number of files that could not be opened
-    int fail_count = 0;
+    // (the profile is written when this goes out of scope, as main() returns)
+    Profile_session profile_session(profile, "profile.json", "profile.trace.json");
 
-    // represents the directory (name) of the output file
-    string output_dir;
+    // the input files are every argument except the second
+    vector<string> input_files;
+    for (vector<string>::size_type i = 0; i != args.size(); ++i) {
+        if (i != 1)
+            input_files.push_back(args[i]);
+    }
+
+    // In streaming mode, the records are written as they are read, so the option is needed first.
+    if (streaming) {
+        if (!text_inputs_only(input_files, "--stream"))
+            return 1;
+        Option option = choose_option();
+        string output_dir = args.size() > 1 ? args[1] : "out.txt";
+        if (needs_whole_roster(option)) {
+            cout << "The \'" << option.label << "\' option needs every record in memory, so ALL is written instead." << endl;
+            option = Option("ALL", output_records_std);
+        }
+
+        vector<Stage_stats> stats;
+        int fail_count = stream_records(input_files, output_dir, option, queue_depth, 4096, stats);
+
+        cout << "Output written to \'" << output_dir << "\'." << endl;
+        write_stage_stats(cout, stats);
+        return fail_count;
+    }
+
+    // With a memory budget, the records are sorted on disk, so the option is needed first too.
+    if (memory_budget > 0) {
+        if (!text_inputs_only(input_files, "--memory-budget"))
+            return 1;
+        Option option = choose_option();
+        string output_dir = args.size() > 1 ? args[1] : "out.txt";
+        if (needs_whole_roster(option)) {
+            cout << "The \'" << option.label << "\' option needs every record in memory, so ALL is written instead." << endl;
+            option = Option("ALL", output_records_std);
+        }
+
+        int fail_count = sort_records_external(input_files, output_dir, option, size_t(memory_budget) << 20);
+        if (fail_count < 0) {
+            cout << "Could not write \'" << output_dir << "\' (or the temporary files beside it)." << endl;
+            return 1;
+        }
+
+        cout << "Output written to \'" << output_dir << "\'." << endl;
+        return fail_count;
+    }
+
+    // holds all the student records read, along with the longest name and how many files were read.
+    Ingest_result input;
 
     // determines whether no input arguments were entered, which indicates
     // that the user will enter the data directly from standard input.
-    bool manual_mode = (argc == 1);
-
-    // read through every command-line argument
-    for(size_t i = 1; i != argc; ++i) {
-        // The non-second input arguments represent input fils to
-        // read student records from 
-        if (i != 2) {
-            // Open the output file (or create a new one)
-            ifstream in_file(argv[i]);
-            // If it was successfully opened, read it.
-            if(in_file) {
-                read_input(in_file, students, maxlen);
-                ++success_count;
-            }
-            // If not, give an appropriate message.
-            else {
-                cout << "Could not open \'" << argv[i] << "\'." << endl;
-                ++fail_count;
-            }
-        }
+    bool manual_mode = args.empty();
+
+    // load the grade cache, if one is used (starting an empty one if there is no cache file yet).
+    Grade_cache cache;
+    Grade_cache* grade_cache = cache_path.empty() ? 0 : &cache;
+    if (grade_cache)
+        cache.load(cache_path);
+
+    // read every input file, either one after the other or in parallel.
+    if (jobs < 0)
+        read_files(input_files, input, grade_cache);
+    else
+        read_files_parallel(input_files, input, jobs, 8 << 20, grade_cache);
+
+    // keep the grades of the lines read for the next run.
+    if (grade_cache && !manual_mode) {
+        if (cache.save(cache_path))
+            cout << "Grade cache: " << cache.hits() << " of " << cache.lines() << " lines unchanged." << endl;
+        else
+            cout << "Could not write the grade cache \'" << cache_path << "\'." << endl;
     }
 
+    vector<Student_info>& students = input.students;
+    string::size_type& maxlen = input.maxlen;
+    int fail_count = input.fail_count;
+
     // The second input argument represents an output file to
     // write the student final grades to. If not entered, use a default one.
-    output_dir =  argc > 2 ? argv[2] : "out.txt";
+    string output_dir = args.size() > 1 ? args[1] : "out.txt";
     
     // If no files were entered, have the data entered the usual way
     // from the standard input stream (i.e. "manual mode").
@@ -211,11 +526,15 @@ int main(int argc, char** argv)
     }
     // If in "input file mode", but the files entered could not be opened, 
     // give an appropriate message and end the program.
-    else if (success_count == 0) {
-        cout << "None of the input files could be opened.\n" << endl;
+    else if (input.success_count == 0) {
+        cout << "None of the input files could be opened and read.\n" << endl;
         return fail_count;
     }
 
+    // warn about any students whose name appears more than once (only looked for by a parallel read).
+    for (vector<string>::const_iterator d = input.duplicates.begin(); d != input.duplicates.end(); ++d)
+        cout << "Duplicate name (" << *d << ") found." << endl;
+
     // if no records were entered (successfully), only give an approprate message.
     if (students.empty()) {
         cout << "No records entered." << endl;
@@ -223,8 +542,8 @@ int main(int argc, char** argv)
 
     // otherwise, output the student records finally.
     else {
-        // first alphabetize the student records
-        sort(students.begin(), students.end(), compare);
+        // first alphabetize the student records (see Name_sort.h)
+        sort_by_name(students);
 
         // get the option that the user selects.
         Option option = choose_option();
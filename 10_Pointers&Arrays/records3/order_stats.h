@@ -0,0 +1,173 @@
+// Guard the header file from multiple inclusions, to prevent an error.
+#ifndef GUARD_order_stats_h
+#define GUARD_order_stats_h
+
+// order_stats.h
+#include <algorithm>    // defines std::nth_element, std::max_element, std::min and std::max
+#include <cstddef>      // defines std::size_t
+#include <stdexcept>    // defines std::domain_error
+#include <vector>       // defines std::vector
+
+/**
+ * ================
+ * ORDER STATISTICS
+ * ================
+ * The k-th order statistic of a sequence is the value that would be in position k if the sequence
+ * were sorted (so the median is the middle order statistic). Sorting the whole sequence just to
+ * find one such value does more work than needed: a *selection* algorithm only moves the values
+ * far enough to put the k-th one in place.
+ *
+ *  - For more than 32 values, std::nth_element is used, which (in the usual libraries) is an
+ *    "introselect": a quickselect that falls back to a slower but guaranteed method if it keeps
+ *    choosing bad pivots. This takes linear time on average, rather than the n log n of a sort.
+ *
+ *  - For 32 values or fewer (the usual number of homework grades), the values are sorted with a
+ *    sorting network instead (see sort_small()), which has no unpredictable branches at all.
+ *
+ * The functions below either work on a range in place (re-ordering it), or on a copy of it held
+ * in a scratch buffer that is kept between calls, so that no new memory is allocated each time.
+ **/
+
+// the largest number of values sorted with a sorting network rather than selected from.
+const std::size_t small_sort_max = 32;
+
+/**
+ * A "compare-exchange" puts the smaller of two values first and the larger second. Written with
+ * std::min and std::max, the compiler can use conditional-move (or min/max) instructions rather
+ * than a branch that the processor would have to guess the outcome of.
+ **/
+template<class T>
+inline void compare_exchange(T& a, T& b)
+{
+    const T lo = std::min(a, b), hi = std::max(a, b);
+    a = lo;
+    b = hi;
+}
+
+/**
+ * ==============
+ * SORTING NETWORK
+ * ==============
+ * A sorting network is a fixed list of compare-exchanges which sorts ANY input of a given size,
+ * whatever the values are. Since the pairs compared never depend on the data, there are no
+ * branches to mispredict.
+ *
+ * The network used here is Batcher's "merge exchange" (Knuth, TAOCP vol. 3, Algorithm 5.2.2M),
+ * which works for any n: for 32 values it does 191 compare-exchanges, against a typical
+ * std::sort's many data-dependent branches.
+ *
+ * Sorts the n values starting at a, in place. (Meant for small n only.)
+ **/
+template<class T>
+void sort_small(T* a, std::size_t n)
+{
+    if (n < 2)
+        return;
+
+    // t = the number of bits needed for n - 1, so that 2^t >= n
+    std::size_t t = 0;
+    while ((std::size_t(1) << t) < n)
+        ++t;
+
+    for (std::size_t p = std::size_t(1) << (t - 1); p > 0; p >>= 1) {
+        std::size_t q = std::size_t(1) << (t - 1), r = 0, d = p;
+        for (;;) {
+            for (std::size_t i = 0; i + d < n; ++i) {
+                if ((i & p) == r)
+                    compare_exchange(a[i], a[i + d]);
+            }
+            if (q == p)
+                break;
+            d = q - p;
+            q >>= 1;
+            r = p;
+        }
+    }
+}
+
+/**
+ * Calculates the median of the n values starting at a, re-ordering them along the way.
+ * (The result is exactly the same as sorting the values and taking the middle one, or the mean of
+ * the middle two.)
+ **/
+template<class T>
+double median_in_place(T* a, std::size_t n)
+{
+    if (n == 0)
+        throw std::domain_error("median of an empty container");
+
+    std::size_t mid = n / 2;
+
+    if (n <= small_sort_max) {
+        sort_small(a, n);
+    } else {
+        // put the mid-th value in its sorted place, with every value before it no larger...
+        std::nth_element(a, a + mid, a + n);
+        // ...so for an even size, the other middle value is the largest of those before it.
+        if (n % 2 == 0)
+            *(a + mid - 1) = *std::max_element(a, a + mid);
+    }
+
+    return n % 2 == 0 ? (a[mid] + a[mid - 1]) / 2.0 : a[mid];
+}
+
+/**
+ * Holds a scratch buffer for calculating order statistics of sequences without modifying them:
+ * each sequence is copied into the buffer and selected from there. The buffer only ever grows,
+ * so after the first few calls, no more memory is allocated.
+ **/
+template<class T> class Order_stats {
+public:
+    Order_stats(): size(0) { }
+
+    // the median of the values in the range [b, e), which is left unchanged.
+    template<class In> double median(In b, In e) {
+        copy_in(b, e);
+        return median_in_place(data(), size);
+    }
+
+    // the k-th smallest value (counting from 0) of the range [b, e), which is left unchanged.
+    template<class In> T nth(In b, In e, std::size_t k) {
+        copy_in(b, e);
+        if (k >= size)
+            throw std::domain_error("order statistic out of range");
+        if (size <= small_sort_max)
+            sort_small(data(), size);
+        else
+            std::nth_element(data(), data() + k, data() + size);
+        return scratch[k];
+    }
+
+    /**
+     * The batch form: the medians of many sequences stored one after another in a single array
+     * (such as every student's homework, one student after another), where sequence i is values[off[i]] to values[off[i+1] - 1].
+     * Writes the median of each of the n sequences to out[i], or 0 for an empty sequence.
+     **/
+    template<class Off> void medians(const T* values, const Off* off, std::size_t n, double* out) {
+        for (std::size_t i = 0; i != n; ++i) {
+            if (off[i] == off[i + 1])
+                out[i] = 0;
+            else
+                out[i] = median(values + off[i], values + off[i + 1]);
+        }
+    }
+
+private:
+    std::vector<T> scratch;
+    std::size_t size;
+
+    T* data() { return scratch.empty() ? 0 : &scratch[0]; }
+
+    template<class In> void copy_in(In b, In e) {
+        size = 0;
+        for (; b != e; ++b) {
+            if (size == scratch.size())
+                scratch.push_back(*b);
+            else
+                scratch[size] = *b;
+            ++size;
+        }
+    }
+};
+
+#endif
@@ -3,6 +3,8 @@
 
 #include <iterator>
 
+#include "Mem_track.h"
+
 
 /**
  * A custom "category" of classes used to represent a simplified List (implementing a doubly-linked list) 
@@ -243,17 +245,25 @@ private:
          * Construtor which sets its value.
          * (Create a copy of the given value, setting the val pointer to its address)
          **/
-        Node(const T& v): val(new T(v)), left(0), right(0) { }
+        Node(const T& v): val(new (mem_track_alloc(sizeof(T), site_lst)) T(v)), left(0), right(0) { }
         
         // destructor
         ~Node()
         {   
             // only destroy the value if it was dynamically allocated in the first place.
             if(val != 0) {
-                delete val;
+                val->~T();
+                mem_track_free(val);
             }      
         }
 
+        /**
+         * Nodes (and their values, above) are allocated as usual with new and delete, except that their memory
+         * is counted against the "Lst" site when tracking memory (see Mem_track.h).
+         **/
+        static void* operator new(std::size_t n) { return mem_track_alloc(n, site_lst); }
+        static void operator delete(void* p) { mem_track_free(p); }
+
         // chain another node to the left of this node
         void left_chain(Node* n) {
             // be sure to first check if this node actually has a left node
@@ -0,0 +1,88 @@
+#ifndef GUARD_Mem_track_h
+#define GUARD_Mem_track_h
+
+#include <cstddef>      // std::size_t
+#include <new>          // placement new
+
+/**
+ * =================
+ * MEMORY TRACKING
+ * =================
+ * To find out which part of a run uses the most memory, every allocation can be TRACKED: counted,
+ * along with its size, against
+ *  - the PHASE of the run it was made in (such as "read" or "sort"), named by a Mem_phase made at the
+ *    start of that part of the program:
+ *
+ *      {
+ *          Mem_phase phase("sort");        // allocations in the rest of this block count as "sort"
+ *          ...
+ *      }
+ *
+ *  - the SITE that made it: a Vec (see Tracking_allocator below), the character array of a Str, a node
+ *    of a Lst, or anything else that uses "new" (std::vector, std::string, ...).
+ *
+ * For each phase and site, the number of allocations, the bytes allocated, the bytes still allocated
+ * ("live"), and the most bytes ever live at once (the "peak") are kept. Each phase also keeps the peak
+ * of the whole program while it was running, which is what decides whether a run fits in memory.
+ *
+ * Tracking is only compiled in when the program is compiled with -DMEM_TRACK, in which case "new" and
+ * "delete" are replaced for the whole program (see Mem_track.cpp), and a report of every phase and site
+ * is written to the standard error stream when the program exits. Otherwise, Tracking_allocator is an
+ * ordinary allocator, and a Mem_phase does nothing.
+ **/
+
+// the sites allocations are counted against
+enum Mem_site { site_new, site_vec, site_str, site_lst, mem_site_count };
+
+/**
+ * Allocates (and frees) raw memory, counting it against the given site and the current phase
+ * (when tracking is compiled in; otherwise it is the same as using ::operator new and ::operator delete).
+ **/
+void* mem_track_alloc(std::size_t bytes, Mem_site site);
+void mem_track_free(void* p);
+
+/**
+ * An allocator, used the same way as std::allocator<T>, that counts the memory it allocates against
+ * the "Vec" site (so it can be used by Vec in place of std::allocator<T>).
+ **/
+template <class T> class Tracking_allocator {
+public:
+    typedef T value_type;
+    typedef std::size_t size_type;
+
+    Tracking_allocator() { }
+    template <class U> Tracking_allocator(const Tracking_allocator<U>&) { }
+
+    T* allocate(size_type n) { return static_cast<T*>(mem_track_alloc(n * sizeof(T), site_vec)); }
+    void deallocate(T* p, size_type) { mem_track_free(p); }
+
+    void construct(T* p, const T& val) { new (p) T(val); }
+    void destroy(T* p) { p->~T(); }
+};
+
+// (any two Tracking_allocators can free each other's memory)
+template <class T, class U>
+bool operator==(const Tracking_allocator<T>&, const Tracking_allocator<U>&) { return true; }
+template <class T, class U>
+bool operator!=(const Tracking_allocator<T>&, const Tracking_allocator<U>&) { return false; }
+
+/**
+ * Counts every allocation made while it exists against the phase of the given name (which must be a
+ * string that lasts the whole run, such as a literal), then goes back to the phase before it.
+ * (The phase is the same for every thread, so allocations made by threads started during a phase
+ * count against it.)
+ **/
+class Mem_phase {
+public:
+    explicit Mem_phase(const char* name);
+    ~Mem_phase();
+
+private:
+    int previous;
+
+    // (copying a phase would end it twice)
+    Mem_phase(const Mem_phase&);
+    Mem_phase& operator=(const Mem_phase&);
+};
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef GUARD_Grade_bands_h
+#define GUARD_Grade_bands_h
+
+#include <cstddef>
+
+/**
+ * =============
+ * GRADE BANDS
+ * =============
+ * A grade band gives a name (e.g. a letter grade) to every grade from some lowest grade upwards,
+ * up to the lowest grade of the band above it. Bands are listed from the highest to the lowest:
+ *
+ *      { {97, "A+"}, {94, "A"}, ..., {0, "F"} }
+ *
+ * Finding the band of a grade by checking each band in turn takes up to one comparison per band.
+ * A Band_table instead works out, when compiling, the band of every grade from 0 to 100 in steps of
+ * a tenth of a point, so that finding a band is a single array lookup (plus one comparison to make
+ * sure of grades that fall between two steps, so the result is always the same as checking in turn).
+ *
+ * Bands are given by their "code": their position in the list (0 for the highest). A grade below the
+ * lowest band (or not a number at all) gets the code size(), whose name is "???".
+ * Names are returned as pointers to the (static) string literals they were given as, so no new string
+ * is made for each grade.
+ **/
+
+struct Grade_band {
+    double lowest;      // the lowest grade in the band
+    const char* name;   // the name of the band
+};
+
+class Band_table {
+public:
+    typedef unsigned char code_type;
+    typedef std::size_t size_type;
+
+    // the most bands a table can have, and the number of steps (tenths of a point) from 0 to 100.
+    static constexpr size_type max_bands = 32;
+    static constexpr int steps = 1000;
+
+    // builds the table for the given bands (listed from highest to lowest).
+    template<size_type N> constexpr explicit Band_table(const Grade_band (&b)[N]): bands(), count(N), index()
+    {
+        static_assert(N <= max_bands, "too many grade bands");
+        // (every element is given a value, as a table built when compiling can't have any left unset)
+        for (size_type i = 0; i != max_bands; ++i)
+            bands[i] = i < N ? b[i] : Grade_band{0, 0};
+        // index[t] is the band of the grade t/10 (i.e. of the lowest grade in the step from t/10 upwards).
+        for (int t = 0; t <= steps; ++t) {
+            size_type c = 0;
+            while (c != N && t / 10.0 < bands[c].lowest)
+                ++c;
+            index[t] = code_type(c);
+        }
+    }
+
+    // the number of bands
+    size_type size() const { return count; }
+
+    // the code of the band a grade falls in
+    code_type code(double grade) const
+    {
+        // (a grade that is not a number is in no band)
+        if (grade != grade)
+            return code_type(count);
+
+        double scaled = grade * 10;
+        size_type c = index[scaled >= steps ? steps : scaled > 0 ? int(scaled) : 0];
+
+        // a grade part of the way through a step may have reached a higher band than the step's lowest grade,
+        // and one just below a step (e.g. after rounding when scaled) may not have reached the step's band.
+        while (c != 0 && grade >= bands[c - 1].lowest)
+            --c;
+        while (c != count && grade < bands[c].lowest)
+            ++c;
+        return code_type(c);
+    }
+
+    // the codes of the n grades starting at grades, written to the n codes starting at out.
+    void codes(const double* grades, size_type n, code_type* out) const
+    {
+        for (size_type i = 0; i != n; ++i)
+            out[i] = code(grades[i]);
+    }
+
+    // the name of a band, given its code ("???" for a grade in no band)
+    const char* name(code_type c) const { return c < count ? bands[c].name : "?\?\?"; }
+
+    // the name of the band a grade falls in
+    const char* name(double grade) const { return name(code(grade)); }
+
+private:
+    Grade_band bands[max_bands];
+    size_type count;
+    code_type index[steps + 1];
+};
+
+#endif
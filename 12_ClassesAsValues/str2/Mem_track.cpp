@@ -0,0 +1,222 @@
+#include <new>
+using std::bad_alloc;
+using std::nothrow_t;
+
+#include "Mem_track.h"
+
+#ifndef MEM_TRACK
+
+// ============ Tracking not compiled in: plain allocation ============
+
+void* mem_track_alloc(std::size_t bytes, Mem_site) { return ::operator new(bytes); }
+void mem_track_free(void* p) { ::operator delete(p); }
+
+Mem_phase::Mem_phase(const char*): previous(0) { }
+Mem_phase::~Mem_phase() { }
+
+#else
+
+#include <atomic>
+using std::atomic;
+
+#include <cstddef>
+using std::max_align_t;
+using std::size_t;
+
+#include <cstdio>
+using std::fprintf;
+using std::snprintf;
+
+#include <cstdlib>
+using std::free;
+using std::malloc;
+
+#include <cstring>
+using std::strcmp;
+
+#include <mutex>
+using std::lock_guard;
+using std::mutex;
+
+/**
+ * Every block is allocated with a small header in front of it, holding its size and the phase and
+ * site it was counted against, so that freeing it can take it off the same counts (even from a later
+ * phase). The header takes up a whole alignment unit, so the memory given out is aligned as malloc's is.
+ **/
+struct Block_header {
+    size_t bytes;
+    unsigned short phase, site;
+};
+static const size_t header_size = alignof(max_align_t);
+static_assert(sizeof(Block_header) <= header_size, "the block header must fit in front of the block");
+
+// the counts of a phase or site (all updated without locking, as they are only ever added to)
+struct Mem_stats {
+    atomic<long long> allocs, bytes, live, peak;
+    atomic<long long> program_peak;     // (phases only: the peak of every phase while this one was current)
+};
+
+// the most phases that may be named (later ones count as the last)
+static const int max_phases = 64;
+
+// the phases named so far (the first for allocations made outside any phase), and the current phase
+static const char* phase_names[max_phases] = { "(no phase)" };
+static Mem_stats phases[max_phases];
+static atomic<int> phase_count(1), current_phase(0);
+static mutex phase_lock;
+
+static const char* const site_names[mem_site_count] = { "new", "Vec", "Str", "Lst" };
+static Mem_stats sites[mem_site_count];
+
+// the bytes live in the whole program, and the most ever live at once
+static atomic<long long> total_live(0), total_peak(0);
+
+// raises a maximum to a value, if it is larger
+static void raise_max(atomic<long long>& m, long long v)
+{
+    long long old = m.load(std::memory_order_relaxed);
+    while (v > old && !m.compare_exchange_weak(old, v, std::memory_order_relaxed))
+        ;
+}
+
+static void count_alloc(Mem_stats& s, long long bytes)
+{
+    s.allocs.fetch_add(1, std::memory_order_relaxed);
+    s.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    raise_max(s.peak, s.live.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+}
+
+void* mem_track_alloc(size_t bytes, Mem_site site)
+{
+    char* p = static_cast<char*>(malloc(header_size + bytes));
+    if (!p)
+        throw bad_alloc();
+
+    Block_header* h = reinterpret_cast<Block_header*>(p);
+    int phase = current_phase.load(std::memory_order_relaxed);
+    h->bytes = bytes;
+    h->phase = (unsigned short) phase;
+    h->site = (unsigned short) site;
+
+    count_alloc(phases[phase], bytes);
+    count_alloc(sites[site], bytes);
+    long long live = total_live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    raise_max(total_peak, live);
+    raise_max(phases[phase].program_peak, live);
+
+    return p + header_size;
+}
+
+void mem_track_free(void* p)
+{
+    if (!p)
+        return;
+    char* block = static_cast<char*>(p) - header_size;
+    const Block_header* h = reinterpret_cast<const Block_header*>(block);
+
+    phases[h->phase].live.fetch_sub(h->bytes, std::memory_order_relaxed);
+    sites[h->site].live.fetch_sub(h->bytes, std::memory_order_relaxed);
+    total_live.fetch_sub(h->bytes, std::memory_order_relaxed);
+    free(block);
+}
+
+Mem_phase::Mem_phase(const char* name)
+{
+    int phase;
+    {
+        // find the phase of this name, or name a new one.
+        lock_guard<mutex> guard(phase_lock);
+        int n = phase_count.load();
+        for (phase = 0; phase != n && strcmp(phase_names[phase], name) != 0; ++phase)
+            ;
+        if (phase == n) {
+            if (n == max_phases)
+                phase = n - 1;
+            else {
+                phase_names[phase] = name;
+                phase_count.store(n + 1);
+            }
+        }
+    }
+    raise_max(phases[phase].program_peak, total_live.load(std::memory_order_relaxed));
+    previous = current_phase.exchange(phase);
+}
+
+Mem_phase::~Mem_phase()
+{
+    current_phase.store(previous);
+}
+
+// ============ Replacing "new" and "delete" for the whole program ============
+
+void* operator new(size_t n) { return mem_track_alloc(n, site_new); }
+void* operator new[](size_t n) { return mem_track_alloc(n, site_new); }
+void* operator new(size_t n, const nothrow_t&) noexcept
+{
+    try { return mem_track_alloc(n, site_new); } catch (bad_alloc&) { return 0; }
+}
+void* operator new[](size_t n, const nothrow_t&) noexcept
+{
+    try { return mem_track_alloc(n, site_new); } catch (bad_alloc&) { return 0; }
+}
+
+void operator delete(void* p) noexcept { mem_track_free(p); }
+void operator delete[](void* p) noexcept { mem_track_free(p); }
+void operator delete(void* p, size_t) noexcept { mem_track_free(p); }
+void operator delete[](void* p, size_t) noexcept { mem_track_free(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { mem_track_free(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { mem_track_free(p); }
+
+// ============ The report ============
+
+// a number of bytes, in the largest unit that keeps it at least 1
+static const char* format_bytes(char* buf, size_t size, long long bytes)
+{
+    static const char* const units[] = { "B", "KB", "MB", "GB", "TB" };
+    double x = double(bytes);
+    int u = 0;
+    while ((x >= 1024 || x <= -1024) && u != 4) {
+        x /= 1024;
+        ++u;
+    }
+    if (u == 0)
+        snprintf(buf, size, "%lld B", bytes);
+    else
+        snprintf(buf, size, "%.1f %s", x, units[u]);
+    return buf;
+}
+
+static void write_row(const char* name, const Mem_stats& s, bool phase)
+{
+    char allocated[32], live[32], peak[32], program_peak[32];
+    fprintf(stderr, "  %-16s %13lld %13s %13s %13s", name, s.allocs.load(),
+            format_bytes(allocated, sizeof(allocated), s.bytes.load()),
+            format_bytes(live, sizeof(live), s.live.load()),
+            format_bytes(peak, sizeof(peak), s.peak.load()));
+    if (phase)
+        fprintf(stderr, " %13s", format_bytes(program_peak, sizeof(program_peak), s.program_peak.load()));
+    fprintf(stderr, "\n");
+}
+
+/**
+ * Writes the report when the program exits (as this object is destroyed, which happens after main()
+ * returns, and so after every other object of main() has been freed).
+ **/
+struct Mem_report {
+    ~Mem_report()
+    {
+        char peak[32];
+        fprintf(stderr, "\nMEMORY REPORT (peak of the whole program: %s)\n",
+                format_bytes(peak, sizeof(peak), total_peak.load()));
+        fprintf(stderr, "  %-16s %13s %13s %13s %13s %13s\n",
+                "phase", "allocations", "allocated", "live at exit", "peak", "program peak");
+        for (int i = 0; i != phase_count.load(); ++i)
+            write_row(phase_names[i], phases[i], true);
+        fprintf(stderr, "  %-16s %13s %13s %13s %13s\n", "site", "allocations", "allocated", "live at exit", "peak");
+        for (int i = 0; i != mem_site_count; ++i)
+            write_row(site_names[i], sites[i], false);
+    }
+};
+static Mem_report report;
+
+#endif
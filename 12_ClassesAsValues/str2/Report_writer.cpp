@@ -0,0 +1,383 @@
+#include <algorithm>
+using std::sort;
+
+#include <atomic>
+using std::atomic;
+
+#include <condition_variable>
+using std::condition_variable;
+
+#include <cstddef>
+using std::size_t;
+
+#include <cstdio>
+using std::snprintf;
+
+#include <cstring>
+using std::memcmp;
+
+#include <fstream>
+using std::ofstream;
+
+#include <ios>
+using std::streamoff;
+
+#include <iostream>
+using std::istream;
+
+#include <mutex>
+using std::mutex;
+using std::unique_lock;
+
+#include <thread>
+using std::thread;
+
+#include <vector>
+using std::vector;
+
+#include "Report_writer.h"
+#include "Str.h"
+#include "Student_info.h"
+#include "Vec.h"
+
+
+const char report_archive_magic[4] = { 'S', 'R', 'A', '2' };
+
+// type mnemonics for the fixed-size fields of an archive
+typedef unsigned long long u64;
+typedef unsigned int u32;
+
+// ---------------------------------- Formatting ----------------------------------
+
+// append the characters of a null-terminated array to the end of a buffer
+static void append(Vec<char>& buf, const char* s)
+{
+    for (; *s; ++s)
+        buf.push_back(*s);
+}
+
+static void append(Vec<char>& buf, const Str& s)
+{
+    for (Str::size_type i = 0; i != s.size(); ++i)
+        buf.push_back(s[i]);
+}
+
+/**
+ * Numbers are formatted with snprintf, using the same conversions an ostream uses by default:
+ * %g with 6 significant digits for a double, and plain decimal for an integer.
+ **/
+static void append(Vec<char>& buf, double x)
+{
+    char s[32];
+    snprintf(s, sizeof(s), "%g", x);
+    append(buf, s);
+}
+
+static void append(Vec<char>& buf, u64 n)
+{
+    char s[24];
+    snprintf(s, sizeof(s), "%llu", n);
+    append(buf, s);
+}
+
+void format_report(Vec<char>& buf, const Report_row& row, size_t total)
+{
+    static const char border_line[] = "=========================\n";
+    const Student_info& s = *row.student;
+
+    append(buf, border_line);
+    append(buf, "Name        : ");
+    append(buf, s.name());
+    append(buf, "\nReg Pos     : ");
+    append(buf, u64(row.reg_pos));
+    append(buf, " / ");
+    append(buf, u64(total));
+    append(buf, "\n");
+
+    if (s.valid()) {
+        append(buf, "Grade       : ");
+        append(buf, s.grade());
+        append(buf, "\nLetter      : ");
+        append(buf, s.letter_grade());
+        append(buf, "\nClass Rank  : ");
+        append(buf, u64(row.class_rank));
+        append(buf, " / ");
+        append(buf, u64(total));
+        append(buf, "\n");
+    }
+    else {
+        append(buf, "Grade       : N/A\nLetter      : N/A\nClass Rank  : N/A\n");
+    }
+    append(buf, border_line);
+}
+
+// ---------------------------------- The writer ----------------------------------
+
+// a batch of formatted reports: those of rows [first, first + ends.size())
+struct Report_batch {
+    size_t first;
+    Vec<char> text;         // the text of every report in the batch, one after the other
+    Vec<size_t> ends;       // where the text of each report ends
+};
+
+Report_writer::Report_writer(unsigned f, unsigned io, size_t size, size_t depth):
+    format_threads(f ? f : 1), io_threads(io ? io : 1), batch_size(size ? size : 1), queue_depth(depth ? depth : 1) { }
+
+template<class Write>
+void Report_writer::run(const Vec<Report_row>& rows, size_t total, bool in_order, Write write) const
+{
+    const size_t batches = (rows.size() + batch_size - 1) / batch_size;
+
+    /**
+     * The queue is a ring of 'queue_depth' slots: batch i always goes in slot i % queue_depth, once the
+     * batch before it in that slot (i - queue_depth) has been written. Each slot is:
+     *  - waiting:  waiting for the formatting thread of its next batch,
+     *  - filling:  being formatted,
+     *  - ready:    formatted, waiting for an I/O thread,
+     *  - writing:  being written.
+     **/
+    enum State { waiting, filling, ready, writing };
+    struct Slot {
+        Report_batch batch;
+        State state;
+        size_t next;        // the next batch to go in this slot
+    };
+    Vec<Slot> slots(queue_depth);
+    for (size_t i = 0; i != queue_depth; ++i) {
+        slots[i].state = waiting;
+        slots[i].next = i;
+    }
+
+    mutex lock;
+    condition_variable changed;
+    size_t next_format = 0;     // the next batch to be formatted
+    size_t taken = 0;           // the number of batches taken by the I/O threads
+
+    // each formatting thread claims the next batch, waits for its slot to be free, and fills it.
+    auto format = [&]() {
+        for (;;) {
+            unique_lock<mutex> guard(lock);
+            size_t i = next_format++;
+            if (i >= batches)
+                return;
+            Slot& slot = slots[i % queue_depth];
+            changed.wait(guard, [&] { return slot.state == waiting && slot.next == i; });
+            slot.state = filling;
+            guard.unlock();
+
+            Report_batch& b = slot.batch;
+            b.first = i * batch_size;
+            b.text.clear();
+            b.ends.clear();
+            size_t last = b.first + batch_size < rows.size() ? b.first + batch_size : rows.size();
+            for (size_t r = b.first; r != last; ++r) {
+                format_report(b.text, rows[r], total);
+                b.ends.push_back(b.text.size());
+            }
+
+            guard.lock();
+            slot.state = ready;
+            changed.notify_all();
+        }
+    };
+
+    // each I/O thread takes a ready batch (the next one in order, if in_order), and writes it.
+    auto output = [&]() {
+        for (;;) {
+            unique_lock<mutex> guard(lock);
+            Slot* slot = 0;
+            changed.wait(guard, [&] {
+                if (taken == batches)
+                    return true;
+                for (size_t s = 0; s != queue_depth && !slot; ++s) {
+                    if (slots[s].state == ready && (!in_order || slots[s].next == taken))
+                        slot = &slots[s];
+                }
+                return slot != 0;
+            });
+            if (!slot)
+                return;
+            slot->state = writing;
+            ++taken;
+            guard.unlock();
+
+            write(slot->batch);
+
+            guard.lock();
+            slot->state = waiting;
+            slot->next += queue_depth;
+            changed.notify_all();
+        }
+    };
+
+    // (the threads are held by value, so none is leaked, and the vector never grows while one is running)
+    const unsigned output_threads = in_order ? 1 : io_threads;
+    vector<thread> threads;
+    threads.reserve(format_threads + output_threads);
+    for (unsigned i = 0; i != format_threads; ++i)
+        threads.push_back(thread(format));
+    for (unsigned i = 0; i != output_threads; ++i)
+        threads.push_back(thread(output));
+    for (vector<thread>::iterator t = threads.begin(); t != threads.end(); ++t)
+        t->join();
+}
+
+size_t Report_writer::write_files(const Vec<Report_row>& rows, size_t total) const
+{
+    atomic<size_t> failed(0);
+
+    run(rows, total, false, [&](const Report_batch& b) {
+        size_t start = 0;
+        for (Vec<size_t>::size_type k = 0; k != b.ends.size(); ++k) {
+            const Str path = "record-" + rows[b.first + k].student->name() + ".txt";
+            ofstream out(path.c_str());
+            out.write(b.text.begin() + start, b.ends[k] - start);
+            if (!out)
+                ++failed;
+            start = b.ends[k];
+        }
+    });
+
+    return failed;
+}
+
+// write a single fixed-size value to an archive
+template<class T> static void write_value(ofstream& out, T x)
+{
+    out.write(reinterpret_cast<const char*>(&x), sizeof(x));
+}
+
+// the size in bytes of an entry of the index, and of the footer (see Report_writer.h)
+static const u64 archive_entry_bytes = 3 * sizeof(u64) + sizeof(u32);
+static const u64 archive_footer_bytes = 2 * sizeof(u64) + 4;
+
+/**
+ * Compares two names by their bytes, giving a negative number, zero or a positive number if the first is
+ * before, the same as or after the second (the order of Str's relational operators, for names without
+ * null characters).
+ **/
+static int compare_names(const char* a, u64 n, const char* b, u64 m)
+{
+    int c = (n < m ? n : m) != 0 ? memcmp(a, b, n < m ? n : m) : 0;
+    return c != 0 ? c : (n < m ? -1 : n > m);
+}
+
+bool Report_writer::write_archive(const char* path, const Vec<Report_row>& rows, size_t total) const
+{
+    ofstream out(path, std::ios::binary);
+    if (!out)
+        return false;
+
+    // (the batches are written in order by a single thread, so where each report lands is known)
+    Vec<u64> offsets, lengths;
+    u64 offset = 0;
+    run(rows, total, true, [&](const Report_batch& b) {
+        out.write(b.text.begin(), b.text.size());
+        size_t start = 0;
+        for (Vec<size_t>::size_type k = 0; k != b.ends.size(); ++k) {
+            offsets.push_back(offset + start);
+            lengths.push_back(b.ends[k] - start);
+            start = b.ends[k];
+        }
+        offset += b.text.size();
+    });
+
+    // the names, one after the other (in the order of the reports), and where each one starts
+    Vec<char> names;
+    Vec<u64> name_starts;
+    for (Vec<Report_row>::size_type i = 0; i != rows.size(); ++i) {
+        name_starts.push_back(names.size());
+        append(names, rows[i].student->name());
+    }
+    name_starts.push_back(names.size());
+
+    // the index is in order of the names, so that a reader can search it.
+    Vec<size_t> order(rows.size());
+    for (Vec<size_t>::size_type i = 0; i != order.size(); ++i)
+        order[i] = i;
+    sort(order.begin(), order.end(), [&](size_t x, size_t y) {
+        return compare_names(names.begin() + name_starts[x], name_starts[x + 1] - name_starts[x],
+                             names.begin() + name_starts[y], name_starts[y + 1] - name_starts[y]) < 0;
+    });
+
+    // the index, then the names, then the footer
+    for (Vec<size_t>::size_type k = 0; k != order.size(); ++k) {
+        size_t i = order[k];
+        write_value(out, offsets[i]);
+        write_value(out, lengths[i]);
+        write_value(out, name_starts[i]);
+        write_value(out, u32(name_starts[i + 1] - name_starts[i]));
+    }
+    out.write(names.begin(), names.size());
+    write_value(out, offset);
+    write_value(out, u64(rows.size()));
+    out.write(report_archive_magic, 4);
+
+    return bool(out);
+}
+
+// read a single fixed-size value from an archive
+template<class T> static bool read_value(istream& in, T& x)
+{
+    return bool(in.read(reinterpret_cast<char*>(&x), sizeof(x)));
+}
+
+bool read_archive_report(istream& in, const Str& name, Str& report)
+{
+    // the size of the archive
+    in.seekg(0, istream::end);
+    const streamoff end = in.tellg();
+    if (end < 0 || u64(end) < archive_footer_bytes)
+        return false;
+    const u64 size = end;
+
+    // the footer: index offset, number of reports, magic
+    u64 index, count;
+    char magic[4];
+    in.seekg(size - archive_footer_bytes);
+    if (!read_value(in, index) || !read_value(in, count) || !in.read(magic, 4) ||
+        memcmp(magic, report_archive_magic, 4) != 0)
+        return false;
+
+    // (the index and the names must fit between the reports and the footer)
+    const u64 rest = size - archive_footer_bytes;
+    if (index > rest || count > (rest - index) / archive_entry_bytes)
+        return false;
+    const u64 names = index + count * archive_entry_bytes;
+    const u64 names_size = rest - names;
+
+    // binary search the index for the name, seeking to each entry (and its name) looked at.
+    u64 lo = 0, hi = count;
+    while (lo < hi) {
+        u64 mid = lo + (hi - lo) / 2;
+        u64 offset, length, name_start;
+        u32 name_size;
+        in.seekg(index + mid * archive_entry_bytes);
+        if (!read_value(in, offset) || !read_value(in, length) || !read_value(in, name_start) ||
+            !read_value(in, name_size) || name_start > names_size || name_size > names_size - name_start)
+            return false;
+
+        Vec<char> chars(name_size);
+        in.seekg(names + name_start);
+        if (name_size != 0 && !in.read(chars.begin(), name_size))
+            return false;
+
+        int c = compare_names(name.data(), name.size(), chars.begin(), name_size);
+        if (c < 0)
+            hi = mid;
+        else if (c > 0)
+            lo = mid + 1;
+        else {
+            // found it: check the report lies within the reports, then seek straight to it and read it.
+            if (offset > index || length > index - offset)
+                return false;
+            Vec<char> text(length);
+            in.seekg(offset);
+            if (length != 0 && !in.read(text.begin(), length))
+                return false;
+            report = Str(text.begin(), text.end());
+            return true;
+        }
+    }
+    return false;
+}
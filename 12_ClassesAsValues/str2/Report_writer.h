@@ -0,0 +1,110 @@
+#ifndef GUARD_Report_writer_h
+#define GUARD_Report_writer_h
+
+#include <cstddef>
+#include <iostream>
+
+#include "Str.h"
+#include "Student_info.h"
+#include "Vec.h"
+
+/**
+ * =====================
+ * THE REPORT WRITER
+ * =====================
+ * Writing each report straight to its own ofstream, line by line with endl, means opening and closing
+ * a file and flushing it several times for every single student.
+ *
+ * The report writer instead splits the reports into batches, and:
+ *  - "formatting" threads each take a batch at a time, and write the text of all its reports into one
+ *    large buffer (without any flushing),
+ *  - "I/O" threads take the finished batches and write each report to its file with a single write.
+ * Only a fixed number of batches (the queue depth) are held in memory at once: the formatting threads
+ * wait for a batch to be written before starting on another once the queue is full.
+ *
+ * Alternatively, every report can be packed into one ARCHIVE file, followed by an index of where each
+ * report starts (see write_report_archive() below), so that a reader can fetch any student's report by
+ * seeking straight to it, rather than opening one file per student.
+ **/
+
+// the details of one student's report (see format_report())
+struct Report_row {
+    const Student_info* student;
+    int reg_pos;        // position in the register (alphabetical order)
+    int class_rank;     // rank of their grade out of the entire class(es)
+};
+
+/**
+ * Appends the text of a student's report to the end of a buffer, exactly as it would be written
+ * line by line to an ostream:
+ *  =========================
+ *  Name        : John
+ *  Reg Pos     : 10 / 20
+ *  Grade       : 85
+ *  Letter      : B
+ *  Class Rank  : 5 / 20
+ *  =========================
+ * (with N/A in place of the grades for an invalid record)
+ **/
+void format_report(Vec<char>&, const Report_row&, std::size_t total);
+
+class Report_writer {
+public:
+    /**
+     * Creates a writer using the given number of formatting and I/O threads, with a number of reports
+     * in each batch, and at most 'queue_depth' batches held in memory at once.
+     **/
+    Report_writer(unsigned format_threads, unsigned io_threads,
+                  std::size_t batch_size = 4096, std::size_t queue_depth = 8);
+
+    /**
+     * Writes the report of each row to its own file, "record-<name>.txt" (in no particular order, so
+     * each name must only appear once). Returns the number of files that could not be written.
+     **/
+    std::size_t write_files(const Vec<Report_row>&, std::size_t total) const;
+
+    /**
+     * Writes the reports of every row, in order, into a single archive file, followed by its index.
+     * Returns false if the archive could not be written.
+     **/
+    bool write_archive(const char* path, const Vec<Report_row>&, std::size_t total) const;
+
+private:
+    unsigned format_threads, io_threads;
+    std::size_t batch_size, queue_depth;
+
+    // formats the rows in batches, handing each finished batch to one of the I/O threads, which call
+    // write(batch) on it. With 'in_order' set, a single I/O thread is given the batches in order.
+    template<class Write> void run(const Vec<Report_row>&, std::size_t total, bool in_order, Write write) const;
+};
+
+/**
+ * ==================
+ * THE ARCHIVE FORMAT
+ * ==================
+ * An archive holds the text of every report, one after the other, followed by the index, the names and a
+ * footer:
+ *
+ *      reports:  the reports, exactly as they would be written to their own files
+ *      index:    for each report, IN ORDER OF THE STUDENTS' NAMES: its offset and length in bytes, where the
+ *                student's name starts among the names (8 bytes each), and the length of the name (4 bytes)
+ *      names:    the names of every student, one after the other
+ *      footer:   the offset of the index (8 bytes), the number of reports (8 bytes), and report_archive_magic
+ *
+ * Every entry of the index is the same size, so a reader finds the footer at the end of the file and then
+ * binary searches the index for a name, seeking straight to each entry it looks at (and to its name), and
+ * from the entry found to the report. Fetching a report then only reads about log2(n) entries of the index,
+ * rather than all of it.
+ **/
+
+// the last bytes of every archive, used to recognise it
+extern const char report_archive_magic[4];
+
+/**
+ * Finds the report of the student with the given name in an archive, replacing the contents of the Str
+ * with it. Returns false if the input is not an archive (or is a damaged one, whose offsets and lengths
+ * do not fit within it), or has no report with that name.
+ **/
+bool read_archive_report(std::istream&, const Str& name, Str& report);
+
+#endif
@@ -0,0 +1,175 @@
+#include <cstring>
+using std::memcmp;
+
+#include <iostream>
+using std::istream;
+
+#include "Roster_bin.h"
+#include "Str.h"
+#include "Student_info.h"
+#include "Vec.h"
+
+
+const char roster_bin_magic[4] = { 'S', 'R', 'B', '1' };
+
+// the version of the layout this program understands (the same as records3's)
+static const unsigned roster_bin_version = 3;
+
+// type mnemonics for the fixed-size fields of the file
+typedef unsigned long long u64;
+
+// the header found at the start of every binary roster file (must match records3's exactly)
+struct Roster_bin_header {
+    char magic[4];
+    unsigned version;
+    u64 count;          // number of student records
+    u64 length_bytes;   // size of the name lengths
+    u64 name_bytes;     // size of the name heap
+    u64 exam_bytes;     // size of the exam grades
+    u64 hw_bytes;       // size of the packed homework blocks
+    u64 grade_bytes;    // size of the final grades (8 bytes a record)
+};
+
+// read a column of n values of type T, replacing the contents of v.
+template<class T>
+bool read_column(istream& in, Vec<T>& v, u64 n)
+{
+    v = Vec<T>(n);
+    if (n != 0)
+        in.read(reinterpret_cast<char*>(v.begin()), n * sizeof(T));
+    return bool(in);
+}
+
+// reads a varint (7 bits a byte, the top bit marking that another byte follows) from [p, end),
+// returning one-past it (or 0 if it runs past the end, or is too long)
+static const unsigned char* read_varint(const unsigned char* p, const unsigned char* end, unsigned& x)
+{
+    x = 0;
+    for (int shift = 0; p != end && shift <= 28; shift += 7) {
+        unsigned char b = *p++;
+        x |= unsigned(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return p;
+    }
+    return 0;
+}
+
+/**
+ * Steps over a packed homework block (the number of grades n, then, if n > 0, a bit width w and
+ * n values of w bits each) in [p, end), setting n but not unpacking the grades themselves, since
+ * only whether a student did any homework is needed here. Returns one-past the block, or 0 if it
+ * is not a valid one, or runs past the end.
+ **/
+static const unsigned char* skip_homework(const unsigned char* p, const unsigned char* end, unsigned& n)
+{
+    p = read_varint(p, end, n);
+    if (p == 0 || n == 0)
+        return p;
+
+    if (p == end)
+        return 0;
+    unsigned w = *p++;
+    u64 bytes = (u64(n) * w + 7) / 8;
+    if (w < 1 || w > 32 || bytes > u64(end - p))
+        return 0;
+    return p + bytes;
+}
+
+bool is_roster_bin(istream& in)
+{
+    char magic[4];
+    istream::pos_type start = in.tellg();
+
+    in.read(magic, 4);
+    bool found = in.gcount() == 4 && memcmp(magic, roster_bin_magic, 4) == 0;
+
+    // put the stream back to where it was, ready to be read either way.
+    in.clear();
+    in.seekg(start);
+    return found;
+}
+
+// the number of bytes from where a stream is to its end (leaving it where it was)
+static u64 bytes_left(istream& in)
+{
+    istream::pos_type start = in.tellg();
+    in.seekg(0, istream::end);
+    istream::pos_type stop = in.tellg();
+    in.clear();
+    in.seekg(start);
+    return start < 0 || stop < start ? 0 : u64(stop - start);
+}
+
+/**
+ * Checks the sizes in a header against the bytes that follow it: the columns must take up exactly
+ * those bytes, and be large enough to hold the number of records (each record takes at least a byte
+ * of the name lengths and the homework blocks, two of the exam grades, and exactly 8 of the grades).
+ **/
+static bool header_fits(const Roster_bin_header& h, u64 available)
+{
+    const u64 columns[] = { h.length_bytes, h.name_bytes, h.exam_bytes, h.hw_bytes, h.grade_bytes };
+    u64 rest = available;
+    if (h.grade_bytes % sizeof(double) != 0 || h.grade_bytes / sizeof(double) != h.count)
+        return false;
+    for (int i = 0; i != 5; ++i) {
+        if (columns[i] > rest)
+            return false;
+        rest -= columns[i];
+    }
+    return rest == 0 && h.count <= h.length_bytes && h.count <= h.exam_bytes / 2 && h.count <= h.hw_bytes;
+}
+
+// marks a stream as failed, for a roster that could not be read
+static bool roster_failed(istream& in)
+{
+    in.setstate(istream::failbit);
+    return false;
+}
+
+bool read_roster_bin(istream& in, Vec<Student_info>& students)
+{
+    Roster_bin_header h;
+    u64 available = bytes_left(in);
+    if (available < sizeof(h) || !in.read(reinterpret_cast<char*>(&h), sizeof(h)) ||
+        memcmp(h.magic, roster_bin_magic, 4) != 0 || h.version != roster_bin_version ||
+        !header_fits(h, available - sizeof(h)))
+        return roster_failed(in);
+
+    // (every column is known to fit in the file now, so none can ask for more memory than that)
+    Vec<unsigned char> lengths, exams, hw;
+    Vec<char> names;
+    Vec<double> grades;
+    if (!read_column(in, lengths, h.length_bytes) || !read_column(in, names, h.name_bytes) ||
+        !read_column(in, exams, h.exam_bytes) || !read_column(in, hw, h.hw_bytes) ||
+        !read_column(in, grades, h.count))
+        return roster_failed(in);
+
+    // check every record, and that every column ends exactly where its last record does, before
+    // adding any of them.
+    const unsigned char* lp = lengths.begin(), * const l_end = lengths.end();
+    const unsigned char* ep = exams.begin(), * const e_end = exams.end();
+    const unsigned char* hp = hw.begin(), * const h_end = hw.end();
+    Vec<unsigned> name_len(h.count), hw_count(h.count);
+    u64 name_pos = 0;
+    for (u64 i = 0; i != h.count; ++i) {
+        unsigned mid, fin;
+        if (!(lp = read_varint(lp, l_end, name_len[i])) || name_len[i] > h.name_bytes - name_pos ||
+            !(ep = read_varint(ep, e_end, mid)) || !(ep = read_varint(ep, e_end, fin)) ||
+            !(hp = skip_homework(hp, h_end, hw_count[i])))
+            return roster_failed(in);
+        name_pos += name_len[i];
+    }
+    if (lp != l_end || name_pos != h.name_bytes || ep != e_end || hp != h_end)
+        return roster_failed(in);
+
+    // the grades were stored already calculated (by the converter), and a record is only valid if
+    // the student did some homework.
+    name_pos = 0;
+    for (u64 i = 0; i != h.count; ++i) {
+        const char* name = names.begin() + name_pos;
+        name_pos += name_len[i];
+        bool valid = hw_count[i] != 0;
+        students.push_back(Student_info(Str(name, name + name_len[i]), valid ? grades[i] : 0, valid));
+    }
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef GUARD_Roster_bin_h
+#define GUARD_Roster_bin_h
+
+#include <iostream>
+
+#include "Student_info.h"
+#include "Vec.h"
+
+/**
+ * Reads binary (columnar) roster files, as written by the --convert mode of the records3
+ * program in Chapter 10 (see ../../10_Pointers&Arrays/records3/Roster_bin.h for the layout).
+ *
+ * Only the names and final grades are kept: the grades were worked out by the converter and stored
+ * in the file, and the homework blocks are only stepped over to find which students did any homework
+ * (a record without homework is invalid). As in records3, the sizes in the header are checked against
+ * the file, and every column against the number of records, before any record is added.
+ **/
+
+// the first bytes of every binary roster file, used to tell it apart from a text roster.
+extern const char roster_bin_magic[4];
+
+/**
+ * Checks whether the input stream is at the start of a binary roster file, without
+ * consuming any of it.
+ **/
+bool is_roster_bin(std::istream&);
+
+/**
+ * Reads an entire binary roster file from an input stream, adding a Student_info to the end
+ * of the Vec for each record. Returns false (with the stream marked as failed, and no records
+ * added) if the file is truncated, corrupt, or not a roster of this version.
+ **/
+bool read_roster_bin(std::istream&, Vec<Student_info>&);
+
+#endif
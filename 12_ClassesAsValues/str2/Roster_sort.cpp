@@ -0,0 +1,102 @@
+#include <algorithm>
+using std::copy;
+using std::merge;
+using std::sort;
+using std::stable_sort;
+
+#include <cstddef>
+using std::size_t;
+
+#include <thread>
+using std::thread;
+
+#include <utility>
+using std::swap;
+
+#include <vector>
+using std::vector;
+
+#include "Roster_sort.h"
+#include "Vec.h"
+
+
+Roster_order& Roster_order::then(Roster_field field, bool desc)
+{
+    // (a field listed again could never decide between two keys, as the first listing already has)
+    for (int i = 0; i != count; ++i) {
+        if (fields[i] == field)
+            return *this;
+    }
+    fields[count] = field;
+    descending[count] = desc;
+    ++count;
+    return *this;
+}
+
+// parts with fewer keys than this are not worth starting a thread for.
+static const size_t min_part = 1 << 14;
+
+// runs task(0), task(1), ..., task(n - 1), each on its own thread (or, for a single task, on this one).
+template<class Task> static void run_parallel(size_t n, Task task)
+{
+    if (n == 1) {
+        task(0);
+        return;
+    }
+    // (held by value, and reserved up front, so no thread is leaked or moved while it runs)
+    vector<thread> threads;
+    threads.reserve(n);
+    for (size_t i = 0; i != n; ++i)
+        threads.push_back(thread(task, i));
+    for (vector<thread>::iterator t = threads.begin(); t != threads.end(); ++t)
+        t->join();
+}
+
+void sort_roster(Vec<Roster_key>& keys, const Roster_order& order, unsigned threads)
+{
+    const size_t n = keys.size();
+
+    // the number of parts: one for each thread, as long as each part is large enough.
+    size_t parts = threads ? threads : 1;
+    if (parts > n / min_part)
+        parts = n / min_part ? n / min_part : 1;
+
+    // where each part starts (with bounds[parts] == n)
+    Vec<size_t> bounds(parts + 1);
+    for (size_t p = 0; p <= parts; ++p)
+        bounds[p] = n * p / parts;
+
+    // 1) sort each part on its own thread
+    Roster_key* data = keys.begin();
+    run_parallel(parts, [&](size_t p) {
+        if (order.stable())
+            stable_sort(data + bounds[p], data + bounds[p + 1], order);
+        else
+            sort(data + bounds[p], data + bounds[p + 1], order);
+    });
+    if (parts == 1)
+        return;
+
+    /**
+     * 2) merge neighbouring parts in pairs, from one buffer into the other, until there is only one part.
+     * merge() takes keys from the first of the two parts when they are equal, so a merge of two stably
+     * sorted parts (the first being the earlier one) is stably sorted too.
+     **/
+    Vec<Roster_key> other(n);
+    Roster_key* from = data;
+    Roster_key* to = other.begin();
+    for (size_t width = 1; width < parts; width *= 2) {
+        const size_t pairs = (parts + 2 * width - 1) / (2 * width);
+        run_parallel(pairs, [&](size_t i) {
+            const size_t b = bounds[2 * width * i];
+            const size_t m = bounds[2 * width * i + width < parts ? 2 * width * i + width : parts];
+            const size_t e = bounds[2 * width * (i + 1) < parts ? 2 * width * (i + 1) : parts];
+            merge(from + b, from + m, from + m, from + e, to + b, order);
+        });
+        swap(from, to);
+    }
+
+    // (the last merge may have left the keys in the other buffer)
+    if (from != data)
+        copy(from, from + n, data);
+}
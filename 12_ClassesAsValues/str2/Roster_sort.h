@@ -0,0 +1,87 @@
+#ifndef GUARD_Roster_sort_h
+#define GUARD_Roster_sort_h
+
+#include "Vec.h"
+
+/**
+ * ===================
+ * SORTING A ROSTER
+ * ===================
+ * Sorting the positions of whole records (Student_info objects) with compare_grade() means reaching
+ * into a different record for every comparison, and can only use one thread.
+ *
+ * A roster is instead sorted by its KEYS: a small, fixed-size summary of each record, holding only what
+ * the records are sorted by, made once before sorting:
+ *  - its grade (with invalid records given the lowest grade of all, -infinity, so they come last when
+ *    sorting from the highest grade down, as compare_grade() puts them),
+ *  - its "name id": the position of its name in alphabetical order (records with the same name sharing
+ *    the same id), so names are compared as integers rather than character by character,
+ *  - its index: the position of the record in the roster, telling us which record the key belongs to.
+ *
+ * A Roster_order lists the fields to sort by, from the most important to the least, e.g.
+ *
+ *      Roster_order order;
+ *      order.then(by_grade, true).then(by_name);   // grade, largest first, then alphabetical order
+ *
+ * and whether the sort is STABLE, i.e. whether keys equal in every listed field stay in the order
+ * they were in (otherwise, their order is unspecified).
+ *
+ * sort_roster() sorts the keys with a parallel merge sort: the keys are split into one part for each
+ * thread, each thread sorts its own part, and the sorted parts are then merged in pairs (each pair by
+ * its own thread), then pairs of those, and so on, until there is only a single sorted part.
+ **/
+
+// the fields a roster can be sorted by
+enum Roster_field { by_grade, by_name, by_index };
+
+// the key of a single record
+struct Roster_key {
+    double grade;           // the grade (-infinity for an invalid record)
+    unsigned name_id;       // the position of the name in alphabetical order
+    unsigned index;         // the position of the record in the roster
+};
+
+class Roster_order {
+public:
+    // an order with no fields yet (in which every key is equal)
+    explicit Roster_order(bool stable = true): count(0), is_stable(stable) { }
+
+    // adds a field to sort by, for keys equal in every field added before it
+    Roster_order& then(Roster_field field, bool descending = false);
+
+    bool stable() const { return is_stable; }
+
+    // does x come before y in this order?
+    bool operator()(const Roster_key& x, const Roster_key& y) const
+    {
+        for (int i = 0; i != count; ++i) {
+            int c = compare(fields[i], x, y);
+            if (c != 0)
+                return descending[i] ? c > 0 : c < 0;
+        }
+        return false;
+    }
+
+private:
+    // (a field can only usefully be listed once, so there are never more than one of each)
+    static const int max_fields = 3;
+    Roster_field fields[max_fields];
+    bool descending[max_fields];
+    int count;
+    bool is_stable;
+
+    // compares a single field of two keys: negative if x's is smaller, 0 if they are equal, positive if larger.
+    static int compare(Roster_field field, const Roster_key& x, const Roster_key& y)
+    {
+        switch (field) {
+        case by_grade:  return (x.grade > y.grade) - (x.grade < y.grade);
+        case by_name:   return (x.name_id > y.name_id) - (x.name_id < y.name_id);
+        default:        return (x.index > y.index) - (x.index < y.index);
+        }
+    }
+};
+
+// sorts the keys into the given order, using (at most) the given number of threads.
+void sort_roster(Vec<Roster_key>&, const Roster_order&, unsigned threads);
+
+#endif
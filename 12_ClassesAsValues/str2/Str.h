@@ -6,6 +6,7 @@
 #include <iostream>     // std::istream, std::ostream
 #include <iterator>     // std::back_inserter
 
+#include "Mem_track.h"
 #include "Vec.h"
 
 
@@ -64,7 +65,7 @@ public:
     // --------------- Destructor ---------------
     ~Str() { 
         // we only need to deallocate the array pointed to by member c. The Vec<char> object will deallocate itself.
-        delete[] c; 
+        mem_track_free(c); 
     }
 
     // --------------- Operators ---------------
@@ -197,7 +198,8 @@ private:
          * Allocate enough space for all the characters making up the Str object, with two extra spaces
          * for an 'init flag' and a terminating null-character (for c_str()).
          **/
-        c = new char[size() + 2];
+        // (counted against the "Str" site when tracking memory, see Mem_track.h; otherwise the same as new char[])
+        c = static_cast<char*>(mem_track_alloc(size() + 2, site_str));
 
         // Set the 'flag' element to the null character, indicating that the array is yet to be set up.
         c[0] = '\0';
@@ -216,7 +218,7 @@ private:
         // unless the check should be ignored, do nothing if the 'init flag' indicates not yet setup ('\0').
         if(!do_check || *c) {
             // deallocate the space taken by the array
-            delete[] c;
+            mem_track_free(c);
             // allocate space for a new array
             allocate_c();
         }
@@ -5,6 +5,7 @@ using std::istream;
 using std::domain_error;
 
 #include "average.h"
+#include "Grade_bands.h"
 #include "median.h"
 #include "Str.h"
 #include "Vec.h"
@@ -63,96 +64,76 @@ double grade(int midterm, int final, Vec<int> hw,
 
 }
 
-// takes a student's grade as input and outputs the letter grade 'tier' it falls into.
-Str letter_grade(double grade)
-{
-    /**
-     * ==========================
-     * Letter grading boundaries:
-     * ==========================
-     *  97 - 100:    A+
-     *  94 -  96:    A
-     *  90 -  93:    A-     
-     *  87 -  89:    B+
-     *  84 -  86:    B
-     *  80 -  83:    B-
-     *  77 -  79:    C+
-     *  74 -  76:    C
-     *  70 -  73:    C-
-     *  60 -  69:    D
-     *   0 -  69     F
-     **/
+/**
+ * ===================================================
+ *          THE TRUTH BEHIND STRING LITERALS
+ * ===================================================
+ * A string literal is a mnemonic for an array of characters
+ * E.g. "hello" is actually the array 
+ *              {'h', 'e', 'l', 'l', 'o', '\0'} 
+ * (where '\0' is a null character added automatically to indicate the end of the char array)
+ * 
+ * Whenever an array is used as a value, the pointer to the first element of an array is used instead
+ * Thus the char* type also represents an array of chars.
+ * And so the name of each band below is a character pointer pointing to such an array.
+ * ===================================================
+ *          THE TWO USES OF THE const KEYWORD
+ * ===================================================
+ * Each band's name is a const char* (see Grade_band in Grade_bands.h), and the table of bands is
+ * constexpr (which makes it, and so every band in it, const as well).
+ * 
+ * - The const of const char* means that each name points to constant chars. That is, their
+ *   values are READ-ONLY (as with input iterators) so that a name can be dereferenced ONLY 
+ *   for reading the characters, NOT for reassigning them. 
+ *   (e.g. "A+" can't be changed to "S", and even "+" to "*" is illegal)
+ * 
+ * - The const of the table means that the name pointers themselves cannot be modified either
+ *   (e.g. by ++, or by assigning another string to them), just as if each were a
+ *   const char* const. Thus each is "locked" at the address it points to.
+ * 
+ * Therefore the bands CANNOT be given other names (the table is const), and the characters of
+ * a name cannot be changed through it (its chars are const). Band_table (see Grade_bands.h) only
+ * ever hands out these same pointers, so every letter grade refers to one of the literals below.
+ **/
 
-    // range posts for numeric grades
-    static const double numbers[] = {
-        97, 94, 90, 87, 84, 80, 77, 74, 70, 60, 0
-    };
-    // names for the letter grades
-    static const char* const letters[] = {
-        "A+", "A", "A-", "B+", "B", "B-", "C+", "C", "C-", "D", "F" 
-    };
-    /**
-     * ===================================================
-     *          THE TRUTH BEHIND STRING LITERALS
-     * ===================================================
-     * A string literal is a mnemonic for an array of characters
-     * E.g. "hello" is actually the array 
-     *              {'H', 'e', 'l', 'l', 'o', '\0'} 
-     * (where '\0' is a null pointer added automatically indicate the end of the char array)
-     * 
-     * Whenever an array is used as a value, the pointer to the first element of an array is used instead
-     * Thus the char* type also represents an array of chars.
-     * And so letters[] is an array of character pointers each poining to an array
-     * ===================================================
-     *          THE TWO USES OF THE const KEYWORD
-     * ===================================================
-     * const char* const letters[]: An array of constant pointers to const char types (arrays).
-     * 
-     * - The fist const (const char*) means that each pointer is to a constant char. That is, their
-     *   values are READ-ONLY (as with input iterators) so that it can be dereferenced ONLY 
-     *   for reading the value, NOT for reassigning it. 
-     *   (e.g. "A+" can't be changed to "S", and even "+" to "*" is illegal)
-     * 
-     * - The second const (char* const) means that each pointer themselves cannot be modified
-     *   (e.g. by ++). Thus it are is "locked" at the address it points to. 
-     * 
-     * Therefore, thinking of it as an array of strings, the elements CANNOT be replaced with
-     * other strings (because of the first const), and a pointer to any of the string cannot be given
-     * another address, and so it cannot point to another element (because of the second const).
-     * 
-     * A reference to letters (used as a pointer) will ALWAYS be a pointer to its first element, 
-     * which is read-only along with the rest of the elements of the array.
-     **/
-    
-    /**
-     * ================ FINDING THE CAPACITY OF AN ARRAY =====================================
-     * There is no simple function for calculating the size of a built-in array in C++.
-     * One has to do basic math with the sizeof() function:
-     * 
-     * sizeof(obj): returns the number of bytes occupied by an object.
-     * 
-     * By calculating the number of bytes occupied by an entire array, and dividing it
-     * by the number of bytes used by any element of the array (each will have the same size),
-     * the size can effectively be found.
-     * ========================================================================================
-     * 
-     * Thus we can compute the number of grades given the size of the array 
-     * and the size of a single element (such as the first)
-     **/
-    static const size_t ngrades = sizeof(numbers) / sizeof(*numbers);
+/**
+ * ==========================
+ * Letter grading boundaries:
+ * ==========================
+ *  97 - 100:    A+
+ *  94 -  96:    A
+ *  90 -  93:    A-     
+ *  87 -  89:    B+
+ *  84 -  86:    B
+ *  80 -  83:    B-
+ *  77 -  79:    C+
+ *  74 -  76:    C
+ *  70 -  73:    C-
+ *  60 -  69:    D
+ *   0 -  59:    F
+ *
+ * Each band is given by its lowest grade and its name, from the highest band down.
+ **/
+constexpr Grade_band letter_grade_bands[] = {
+    {97, "A+"}, {94, "A"}, {90, "A-"}, {87, "B+"}, {84, "B"}, {80, "B-"}, {77, "C+"}, {74, "C"}, {70, "C-"},
+    {60, "D"}, {0, "F"}
+};
 
-    // given a numeric grade, find and return the associated letter grade
-    for (size_t i = 0; i < ngrades; ++i) {
-        if (grade >= numbers[i])
-            return letters[i];
-    }
+/**
+ * The lookup table of the letter grade of every grade (see Grade_bands.h), built when compiling.
+ * (The Band_table constructor takes the array by reference, so it knows the number of bands
+ * from the array's type, without needing to divide its sizeof() by the size of an element.)
+ **/
+extern constexpr Band_table letter_bands(letter_grade_bands);
 
-    /**
-     * If the grade is invalid (<0) then return "???" to indicate this.
-     * (The escape sequence \?, which still gives ?, is used since ?? is a trigraph - that is,
-     * it is treated by C++ as a single character meaning something different)
-     **/
-    return "?\?\?";
+/**
+ * Takes a student's grade as input and outputs the letter grade 'tier' it falls into,
+ * as a pointer to its name in the table (so no new string is made for every student).
+ * If the grade is invalid (<0) then "???" is returned to indicate this.
+ **/
+const char* letter_grade(double grade)
+{
+    return letter_bands.name(grade);
 }
 
 // =============================== Definitions of Student_info member functions ================================================
@@ -160,6 +141,7 @@ Str letter_grade(double grade)
 // ----------------------------------- Constructors ----------------------------
 Student_info::Student_info(): final_grade(0), v(false){ }
 Student_info::Student_info(istream& is) { read(is); }
+Student_info::Student_info(const Str& name, double g, bool valid): n(name), final_grade(g), v(valid) { }
 
 // ------------------------- (Public) member functions ---------------------------
 double Student_info::grade() const
@@ -170,7 +152,7 @@ double Student_info::grade() const
     return final_grade;
 }
 
-Str Student_info::letter_grade() const
+const char* Student_info::letter_grade() const
 {   
     // throw an error if the student record is invalid (due to no homework)
     if (!valid())
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <iostream>
 
+#include "Grade_bands.h"
 #include "Str.h"
 
 
@@ -35,6 +36,8 @@ public:
     Student_info();
     // initialise directly from user input                
     Student_info(std::istream&);
+    // initialise from an already-graded record (e.g. one loaded from a binary roster file)
+    Student_info(const Str&, double, bool);
 
     // ----------------------------------- (Public) member functions ------------------------
     // (The const keyword is used to guarantee that no data members are changed by the grade() function.)
@@ -48,8 +51,8 @@ public:
     // ----- "Method" functions ------
     // get student's (final) grade (will be slightly more than a simple "getter" function)
     double grade() const;
-    // calculates the letter grade of the student based on their final grade
-    Str letter_grade() const;
+    // finds the letter grade of the student based on their final grade (a static string, see Grade_bands.h)
+    const char* letter_grade() const;
     // interpret user's input to initialise the Student_info object
     std::istream& read(std::istream&);
 
@@ -61,6 +64,10 @@ public:
 
 // --- (Note these this functions are OUTSIDE the class) ---
 
+// the letter grade bands, and the letter grade of a final grade (see Grade_bands.h)
+extern const Band_table letter_bands;
+const char* letter_grade(double);
+
 // used to determine how two student records should be ordered
 bool compare(const Student_info&, const Student_info&);
 
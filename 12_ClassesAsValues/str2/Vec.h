@@ -5,6 +5,8 @@
 #include <cstddef>      // std::ptrdiff_t and std::size_t
 #include <memory>       // std::allocate<T>, std::uniuninitialized_copy, std::uninitialized_fill
 
+#include "Mem_track.h"  // Tracking_allocator<T>
+
 /**
  * A custom "category" of classes used to represent a vector of elements of a particular type
  * ===============
@@ -123,7 +125,8 @@ private:
     // -------- Facilites for memory allocation --------
 
     // member object to handle memory allocation
-    std::allocator<T> alloc; 
+    // (used just as a std::allocator<T> would be, but counting the memory it allocates, see Mem_track.h)
+    Tracking_allocator<T> alloc; 
 
     // allocates and initializes the underlying array that will hold the elements
     // (base initializer, creating an empty Vec)
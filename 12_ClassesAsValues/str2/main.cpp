@@ -2,8 +2,6 @@
 #include <algorithm>
 using std::back_inserter;
 using std::transform;
-using std::find;
-using std::find_if;
 using std::sort;
 using std::stable_sort;
 
@@ -18,37 +16,100 @@ using std::ostream;
 using std::ifstream;
 using std::ofstream;
 
+#include <cstddef>
+using std::size_t;
+
+#include <cstdlib>
+using std::atoi;
+
+#include <limits>
+using std::numeric_limits;
+
+#include <thread>
+using std::thread;
+
+#include <unordered_set>
+using std::unordered_set;
+
+#include "Mem_track.h"
+#include "Report_writer.h"
+#include "Roster_bin.h"
+#include "Roster_sort.h"
 #include "Str.h"
 #include "Student_info.h"
 #include "Vec.h"
 
+/**
+ * Hashes a Str from its characters (using the "FNV-1a" hash), so that Str objects can be kept
+ * in a hash table such as std::unordered_set.
+ **/
+struct Str_hash {
+    size_t operator()(const Str& s) const {
+        size_t h = 14695981039346656037ULL;
+        for (Str::size_type i = 0; i != s.size(); ++i) {
+            h ^= (unsigned char) s[i];
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+};
+
+// a set of names, for finding whether a name has been read already without searching through each one.
+typedef unordered_set<Str, Str_hash> Name_set;
+
+/**
+ * Adds a student record to the end of a Vec, unless its name matches one of those
+ * read so far, in which case it is discarded.
+ **/
+void add_record(const Student_info& record, Vec<Student_info>& students, Name_set& read_names)
+{
+    // to prevent duplicates, we only add records that have a unique name - not matching those read so far.
+    // (insert() only adds the name if it is not already in the set, and tells us whether it did)
+    if(read_names.insert(record.name()).second) {
+        students.push_back(record);
+    }
+    // if the student's name already exists, the record read will be discarded.
+    else {
+        cout << "Duplicate name (" << record.name() << ") will be ignored." << endl;
+    }
+}
+
 /**
  * Reads from an input stream student grade data and adds it to the end of a
  * Vec. Duplicate student names will not be added.
+ *
+ * The input may either be a text roster, or a binary roster written by records3's
+ * --convert mode (see Roster_bin.h). Returns false (adding no records) if it is a binary
+ * roster that could not be read.
  **/
-void read_input(istream& in, Vec<Student_info>& students)
+bool read_input(istream& in, Vec<Student_info>& students)
 {   
+    // (the memory allocated while reading counts against the "read" phase, see Mem_track.h)
+    Mem_phase phase("read");
+
     // used to hold the current record being read from the input
     Student_info record;
 
     // used to hold all the names read so far.
-    Vec<Str> read_names;
-
-    while (record.read(in)) {
+    Name_set read_names;
 
-        // to prevent duplicates, we only add records that have a unique name - not matching those read so far.
-        if(find(read_names.begin(), read_names.end(), record.name()) == read_names.end()) {
-            students.push_back(record);
-            read_names.push_back(record.name());
-        }
-        // if the student's name already exists, the record read will be discarded.
-        else {
-            cout << "Duplicate name (" << record.name() << ") will be ignored." << endl;
-        }
+    if (is_roster_bin(in)) {
+        // load every record first, then filter out the duplicates as usual.
+        Vec<Student_info> loaded;
+        if (!read_roster_bin(in, loaded))
+            return false;
+        for (Vec<Student_info>::const_iterator it = loaded.begin(); it != loaded.end(); ++it)
+            add_record(*it, students, read_names);
+        return true;
     }
+
+    while (record.read(in))
+        add_record(record, students, read_names);
+    return true;
 }
 /**
- *  Writes each student record to a separate file.
+ *  Writes each student record to a separate file (or, given the path of an archive, all of them into
+ *  that archive, see Report_writer.h), using the given number of threads.
  *  
  *  Example of a student record:
  *  =========================
@@ -59,109 +120,158 @@ void read_input(istream& in, Vec<Student_info>& students)
  *  Class Rank  : 5 / 20       // Rank of student's grade out of entire class.
  *  =========================
  * (Stored in record-John.txt)
+ *
+ * Returns the number of files that could not be written.
  **/
-void create_record_files(Vec<Student_info>& students)
+int create_record_files(const Vec<Student_info>& students, unsigned jobs, const char* archive)
 {   
     // Type mnemonics
-    typedef Vec<Student_info>::const_iterator c_iter;
     typedef Vec<Student_info>::size_type size_type;
 
-    // Top and bottom border lines
-    const Str border_line(25, '=');
-
-    // Define labels
-    const Str l_name       = "Name        : ";
-    const Str l_reg_pos    = "Reg Pos     : ";
-    const Str l_grade      = "Grade       : ";
-    const Str l_letter     = "Letter      : ";
-    const Str l_class_rank = "Class Rank  : ";
-
     // Get total number of student records
     const size_type total = students.size();
 
-    // Sort student records by the order of their names, in lexigraphical order
-    sort(students.begin(), students.end(), compare);
-
-    // Add the names to a Vec.
-    Vec<Str> names;
-    for(c_iter it = students.begin(); it != students.end(); ++it) {
-        names.push_back(it->name());
-    }
-
-    // Sort student records by the order of their grades, largest to smallest.
-    sort(students.begin(), students.end(), compare_grade);
-
-    // The rank of the student out of the entire class(es)
-    int class_rank = 1;
+    /**
+     * Rather than sorting the records themselves, we sort their positions in the Vec (a "permutation"),
+     * which avoids copying whole records around, and lets us work out each student's register position
+     * once, while the positions are in name order, rather than searching through the names for each.
+     *
+     * (Sorting the positions with the same comparisons gives exactly the same order as sorting the records.)
+     **/
+    Mem_phase sort_phase("sort");
+    Vec<size_type> order(total);
+    for (size_type i = 0; i != total; ++i)
+        order[i] = i;
 
-    // Iterate over the student records, writting each to an individual file.
-    for(c_iter it = students.begin(); it != students.end(); ++it) {
+    // Sort the records by the order of their names, in lexigraphical order
+    sort(order.begin(), order.end(),
+         [&students](size_type a, size_type b) { return compare(students[a], students[b]); });
 
-        // Get the student's name
-        const Str name = it->name();
+    // The position (starting with 1) of each record's name, representing register order in the class(es).
+    // (records sharing a name share the position of the first of them)
+    Vec<int> reg_positions(total);
+    for (size_type i = 0; i != total; ++i) {
+        if (i != 0 && students[order[i]].name() == students[order[i - 1]].name())
+            reg_positions[order[i]] = reg_positions[order[i - 1]];
+        else
+            reg_positions[order[i]] = i + 1;
+    }
 
-        // Find first occurance of the name in the Vec.
-        Vec<Str>::const_iterator name_it = find(names.begin(), names.end(), name);
+    /**
+     * Sort the records by the order of their grades, largest to smallest, with records of the same grade
+     * in alphabetical order (see Roster_sort.h). The register positions serve as the name ids, as they
+     * are already in alphabetical order.
+     **/
+    Vec<Roster_key> keys(total);
+    for (size_type i = 0; i != total; ++i) {
+        keys[i].grade = students[i].valid() ? students[i].grade() : -numeric_limits<double>::infinity();
+        keys[i].name_id = reg_positions[i];
+        keys[i].index = i;
+    }
+    Roster_order by_rank;
+    by_rank.then(by_grade, true).then(by_name);
+    sort_roster(keys, by_rank, jobs);
+    for (size_type rank = 0; rank != total; ++rank)
+        order[rank] = keys[rank].index;
 
-        // Get the position (starting with 1) of the name, representing register order in the class(es)
-        const int reg_pos = (name_it - names.begin()) + 1;
-        
-        // Create an output file to write the record to.
-        ofstream out(("record-" + name + ".txt").c_str());
+    /**
+     * The report of each student, in order of their grades (so the rank of the student out of the entire
+     * class(es) is their position in this order).
+     *
+     * Records with the same name (read from different files) would be written to the same file, each
+     * replacing the last, so only the last of them in this order is kept. (The reports are written in
+     * no particular order, so the others must not be written at all.)
+     **/
+    Vec<bool> kept(total);
+    Name_set seen;
+    for (size_type rank = total; rank != 0; --rank)
+        kept[rank - 1] = seen.insert(students[order[rank - 1]].name()).second;
 
-        // ----- Write the record to the output file ------
+    Vec<Report_row> rows;
+    for (size_type rank = 0; rank != total; ++rank) {
+        if (kept[rank]) {
+            Report_row row = { &students[order[rank]], reg_positions[order[rank]], int(rank + 1) };
+            rows.push_back(row);
+        }
+    }
 
-        // Write a top border line.
-        out << border_line << endl;
-        // Output the name and the student's position in the register.
-        out << l_name << name << endl;  
-        out << l_reg_pos << reg_pos << " / " << total << endl;  
+    // Format the reports and write them out, on separate threads (see Report_writer.h)
+    Mem_phase write_phase("write");
+    Report_writer writer(jobs, jobs < 4 ? jobs : 4);
+    if (archive)
+        return writer.write_archive(archive, rows, total) ? 0 : 1;
+    return writer.write_files(rows, total);
+}
 
-        // Write data relating to the student grade if it is valid
-        if(it->valid()) {
-            out << l_grade << it->grade() << endl;
-            out << l_letter << it->letter_grade() << endl;
-            out << l_class_rank << class_rank << " / " << total << endl;
-        }
-        // Otherwise write "N/A" at the points where the data would have been
-        else {
-            out << l_grade << "N/A" << endl;
-            out << l_letter << "N/A" << endl;
-            out << l_class_rank << "N/A" << endl;
-        }        
-        // Finally write a bottom border line.
-        out << border_line << endl;
-
-        ++class_rank;
+/**
+ * Prints the report of a single student, found in an archive written by create_record_files().
+ * Returns 1 if it could not be found.
+ **/
+int extract_record(const char* archive, const char* name)
+{
+    ifstream in(archive, std::ios::binary);
+    Str report;
+    if (!in || !read_archive_report(in, name, report)) {
+        cout << "No record for \'" << name << "\' found in \'" << archive << "\'." << endl;
+        return 1;
     }
+    cout << report;
+    return 0;
 }
 
 int main(int argc, char** argv)
 {   
+    // "--extract <archive> <name>" prints a single student's report from an archive, instead.
+    if (argc == 4 && Str(argv[1]) == "--extract")
+        return extract_record(argv[2], argv[3]);
+
     // define Vec for holding all the student records read.
     Vec<Student_info> students;
 
-    // represents the number of files that could be opened
+    /**
+     * The options, which may come before the input files:
+     *  --jobs N:          the number of threads to sort and write the reports with (by default, one for each core)
+     *  --archive <file>:  write every report into a single archive file, instead of one file each
+     **/
+    unsigned jobs = thread::hardware_concurrency();
+    const char* archive = 0;
+    int first = 1;
+    for (; first + 1 < argc; first += 2) {
+        if (Str(argv[first]) == "--jobs")
+            jobs = atoi(argv[first + 1]);
+        else if (Str(argv[first]) == "--archive")
+            archive = argv[first + 1];
+        else
+            break;
+    }
+
+    // represents the number of files that could be opened and read
     int success_count = 0;
-    // represents the number of files that could not be opened
+    // represents the number of files that could not be opened or read
     int fail_count = 0;
 
     // Determines whether no input arguments were entered, which indicates
     // that the user will enter the data directly from standard input.
-    bool manual_mode = (argc <= 1);
+    bool manual_mode = (argc <= first);
 
     /** 
      * Read through every command-line argument, 
      * which represent the input files to read student records from 
-     * (except the first, which is the name of the exectable file).
+     * (except the first, which is the name of the exectable file, and the options).
      **/
-    for(size_t i = 1; i != argc; ++i) {
-        // Open the output file (or create a new one)
-        ifstream in_file(argv[i]);
-        // If it was successfully opened, read it.
+    for(int i = first; i < argc; ++i) {
+        // Open the input file (in binary mode, in case it is a binary roster)
+        ifstream in_file(argv[i], std::ios::binary);
+        // If it was successfully opened, read it (a binary roster that turns out to be
+        // truncated or corrupt counts as a file that could not be read).
         if(in_file) {
-            read_input(in_file, students);
-            ++success_count;
+            if (read_input(in_file, students)) {
+                ++success_count;
+            }
+            else {
+                cout << "Could not read \'" << argv[i] << "\' (a truncated or corrupt binary roster)." << endl;
+                ++fail_count;
+            }
         }
         // If not, give an appropriate message.
         else {
@@ -184,7 +294,7 @@ int main(int argc, char** argv)
     // if in "input file mode", but the files entered could not be opened, 
     // give an appropriate message and end the program.
     else if (success_count == 0) {
-        cout << "None of the input files could be opened.\n" << endl;
+        cout << "None of the input files could be opened and read.\n" << endl;
         return fail_count;
     }
 
@@ -195,7 +305,7 @@ int main(int argc, char** argv)
 
     // otherwise, write the student record files finally.
     else {
-        create_record_files(students);
+        fail_count += create_record_files(students, jobs, archive);
     }
 
     // return the number of failed processes, to help determine how successful the program was.